@@ -22,6 +22,8 @@ static nlohmann::json CollectAsset (const core::AssetSerializedTypeInfo& info);
 static nlohmann::json CollectStruct (const core::StructSerializedTypeInfo& info);
 
 static nlohmann::json CollectPlugins (const PhenylRuntime& runtime);
+static nlohmann::json CollectMemory (const PhenylRuntime& runtime);
+static nlohmann::json CollectComponentMemory (const core::ComponentMemoryStats& stats);
 
 int main (int argc, char* argv[]) {
     if (argc != 2) {
@@ -62,7 +64,8 @@ int main (int argc, char* argv[]) {
 
     nlohmann::json result{
       {"components", CollectComponents(runtime)}, //
-      {"plugins", CollectPlugins(runtime)}        //
+      {"plugins", CollectPlugins(runtime)},       //
+      {"memory", CollectMemory(runtime)}          //
     };
     std::cout << result.dump(4) << "\n";
 }
@@ -205,3 +208,48 @@ nlohmann::json CollectStruct (const core::StructSerializedTypeInfo& info) {
 static nlohmann::json CollectPlugins (const PhenylRuntime& runtime) {
     return nlohmann::json{runtime.plugins()};
 }
+
+nlohmann::json CollectMemory (const PhenylRuntime& runtime) {
+    auto stats = runtime.memoryStats();
+
+    std::vector<nlohmann::json> archetypes;
+    for (const auto& archetype : stats.archetypes) {
+        nlohmann::json archJson;
+        archJson["entities"] = archetype.entities;
+        archJson["used_bytes"] = archetype.usedBytes;
+        archJson["reserved_bytes"] = archetype.reservedBytes;
+        archJson["edges"] = archetype.edges;
+
+        std::vector<nlohmann::json> components;
+        for (const auto& i : archetype.components) {
+            components.emplace_back(CollectComponentMemory(i));
+        }
+        archJson["components"] = std::move(components);
+        archetypes.emplace_back(std::move(archJson));
+    }
+
+    std::vector<nlohmann::json> components;
+    for (const auto& i : stats.components) {
+        components.emplace_back(CollectComponentMemory(i));
+    }
+
+    nlohmann::json json;
+    json["used_bytes"] = stats.usedBytes;
+    json["reserved_bytes"] = stats.reservedBytes;
+    json["entity_used_bytes"] = stats.entityUsedBytes;
+    json["entity_reserved_bytes"] = stats.entityReservedBytes;
+    json["empty_archetypes"] = stats.emptyArchetypes;
+    json["edges"] = stats.edges;
+    json["archetypes"] = std::move(archetypes);
+    json["components"] = std::move(components);
+    return json;
+}
+
+nlohmann::json CollectComponentMemory (const core::ComponentMemoryStats& stats) {
+    nlohmann::json json;
+    json["name"] = stats.name;
+    json["count"] = stats.count;
+    json["used_bytes"] = stats.usedBytes;
+    json["reserved_bytes"] = stats.reservedBytes;
+    return json;
+}
@@ -203,10 +203,6 @@ public:
 
     void finishRender () override {}
 
-    graphics::PipelineBuilder buildPipeline () override {
-        return graphics::PipelineBuilder{std::make_unique<MockPipelineBuilder>()};
-    }
-
     void loadDefaultShaders () override {}
 
     graphics::Viewport& getViewport () override {
@@ -220,6 +216,10 @@ public:
     void render () override {}
 
 protected:
+    std::unique_ptr<graphics::IPipelineBuilder> makeRendererPipelineBuilder () override {
+        return std::make_unique<MockPipelineBuilder>();
+    }
+
     std::unique_ptr<graphics::IBuffer> makeRendererBuffer (std::size_t startCapacity, std::size_t elementSize,
         graphics::BufferStorageHint storageHint, bool isIndex) override {
         return std::make_unique<MockBuffer>();
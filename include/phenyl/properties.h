@@ -3,9 +3,20 @@
 #include "../../modules/graphics/backends/api/include/graphics/graphics_properties.h"
 #include "logging/properties.h"
 
+#include <cstdint>
+#include <string>
+
 namespace phenyl {
 class PhenylEngine;
 
+// What happens to fixed timesteps owed beyond the per frame cap
+enum class FixedStepOverflow {
+    // Skipped, so the simulation falls behind real time after a slow frame
+    Drop,
+    // Carried into later frames, up to one frame's cap, so the simulation runs slower until it catches up
+    SlowDown
+};
+
 namespace engine {
     class Engine;
 }
@@ -14,6 +25,14 @@ class ApplicationProperties {
 private:
     graphics::GraphicsProperties m_graphics;
     logging::LoggingProperties m_logging;
+    bool m_headless = false;
+    bool m_uncapped = false;
+    bool m_pipelinedRendering = false;
+    std::uint64_t m_frameLimit = 0;
+    std::uint64_t m_fixedStepLimit = 0;
+    std::uint32_t m_maxFixedSteps = 8;
+    FixedStepOverflow m_fixedStepOverflow = FixedStepOverflow::Drop;
+    std::string m_traceFile;
 
     friend class engine::Engine;
     friend class PhenylEngine;
@@ -39,6 +58,63 @@ public:
         return *this;
     }
 
+    // Runs without a window or GPU, with a renderer that draws nothing
+    ApplicationProperties& withHeadless (const bool headless = true) {
+        m_headless = headless;
+
+        return *this;
+    }
+
+    // Runs frames back to back with exactly one fixed timestep each instead of pacing them to real time, so the
+    // simulation runs as fast as it can be stepped
+    ApplicationProperties& withUncappedFixedStep (const bool uncapped = true) {
+        m_uncapped = uncapped;
+
+        return *this;
+    }
+
+    // Renders each frame on a dedicated thread while the next frame is simulated. Render layers, and data they read
+    // such as uniform buffer contents, may then only be written during the Render stage. Resource handles made by the
+    // Renderer take Renderer::lockResources() to be created, uploaded to or destroyed, so can be used from any stage
+    // but wait for the frame being rendered. Any other use of the graphics backend must hold that lock
+    ApplicationProperties& withPipelinedRendering (const bool pipelined = true) {
+        m_pipelinedRendering = pipelined;
+
+        return *this;
+    }
+
+    // Stops after this many frames, or never if 0
+    ApplicationProperties& withFrameLimit (const std::uint64_t frames) {
+        m_frameLimit = frames;
+
+        return *this;
+    }
+
+    // Stops after this many fixed timesteps, or never if 0
+    ApplicationProperties& withFixedStepLimit (const std::uint64_t steps) {
+        m_fixedStepLimit = steps;
+
+        return *this;
+    }
+
+    // Caps the fixed timesteps run in one frame, so a slow frame can't cause ever more timesteps to catch up on.
+    // 0 removes the cap
+    ApplicationProperties& withMaxFixedSteps (const std::uint32_t maxSteps,
+        const FixedStepOverflow overflow = FixedStepOverflow::Drop) {
+        m_maxFixedSteps = maxSteps;
+        m_fixedStepOverflow = overflow;
+
+        return *this;
+    }
+
+    // Records timing zones for every stage, system and deferred flush and writes them to this file as Chrome trace
+    // event JSON on exit. Empty disables tracing
+    ApplicationProperties& withTraceFile (std::string traceFile) {
+        m_traceFile = std::move(traceFile);
+
+        return *this;
+    }
+
     ApplicationProperties& withLogFile (std::string logFile) {
         m_logging.withLogFile(std::move(logFile));
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace phenyl::core::bench {
+using Clock = std::chrono::steady_clock;
+
+// Microseconds taken by fn
+template <typename F>
+double Time (F&& fn) {
+    auto start = Clock::now();
+    fn();
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Fastest of several runs of fn in microseconds, which is the least disturbed by the rest of the machine
+template <typename F>
+double BestOf (int runs, F&& fn) {
+    double best = Time(fn);
+    for (int i = 1; i < runs; i++) {
+        best = std::min(best, Time(fn));
+    }
+    return best;
+}
+
+// Value below which the given fraction of samples lie
+inline double Percentile (std::vector<double> samples, double fraction) {
+    auto index = std::min(static_cast<std::size_t>(static_cast<double>(samples.size()) * fraction), samples.size() - 1);
+    std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(index));
+    return samples[index];
+}
+
+inline void Report (std::string_view name, double micros) {
+    std::cout << name << ": " << micros << " us\n";
+}
+} // namespace phenyl::core::bench
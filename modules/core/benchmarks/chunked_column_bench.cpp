@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "core/world.h"
+
+using namespace phenyl::core;
+
+namespace {
+struct Position {
+    float x = 0, y = 0, z = 0;
+};
+
+struct Velocity {
+    float x = 1, y = 1, z = 1;
+};
+
+struct Payload {
+    float data[32] = {};
+};
+
+constexpr std::size_t Waves = 4000;
+constexpr std::size_t WaveSize = 64;
+constexpr int IterateRuns = 20;
+} // namespace
+
+// Spawns entities in small waves into one archetype, which is where growing a contiguous column has to move every row
+// already in it. Reports the spread of wave times and the cost of iterating the resulting columns
+int main () {
+    World world;
+    world.addComponent<Position>("Position");
+    world.addComponent<Velocity>("Velocity");
+    world.addComponent<Payload>("Payload");
+    auto query = world.query<Position, const Velocity>();
+
+    std::vector<double> waves;
+    waves.reserve(Waves);
+    for (std::size_t i = 0; i < Waves; i++) {
+        waves.emplace_back(bench::Time([&] { world.spawnBatch(WaveSize, Position{}, Velocity{}, Payload{}); }));
+    }
+
+    double total = 0;
+    for (auto wave : waves) {
+        total += wave;
+    }
+    bench::Report("spawn total", total);
+    bench::Report("spawn wave p50", bench::Percentile(waves, 0.5));
+    bench::Report("spawn wave p99", bench::Percentile(waves, 0.99));
+    bench::Report("spawn wave p99.9", bench::Percentile(waves, 0.999));
+    bench::Report("spawn wave max", *std::ranges::max_element(waves));
+
+    float sum = 0;
+    auto iterate = bench::BestOf(IterateRuns, [&] {
+        query.each([&] (Position& pos, const Velocity& vel) {
+            pos.x += vel.x;
+            sum += pos.x;
+        });
+    });
+    bench::Report("iterate", iterate);
+
+    // Keeps the iteration from being optimised out
+    return sum < 0;
+}
@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "core/component/detail/component_vector.h"
+
+#include <string>
+
+using namespace phenyl::core;
+
+namespace {
+struct Trivial {
+    float data[16] = {};
+};
+
+// Same layout as Trivial, but with user-provided operations the compiler cannot reduce to plain copies
+struct Typed {
+    float data[16] = {};
+
+    Typed () = default;
+
+    Typed (const Typed& other) {
+        std::ranges::copy(other.data, data);
+    }
+
+    Typed (Typed&& other) noexcept {
+        std::ranges::copy(other.data, data);
+    }
+
+    Typed& operator= (const Typed& other) {
+        std::ranges::copy(other.data, data);
+        return *this;
+    }
+
+    Typed& operator= (Typed&& other) noexcept {
+        std::ranges::copy(other.data, data);
+        return *this;
+    }
+
+    ~Typed () {}
+};
+
+static_assert(sizeof(Trivial) == sizeof(Typed));
+static_assert(std::is_trivially_copyable_v<Trivial> && !std::is_trivially_copyable_v<Typed>);
+
+constexpr std::size_t Rows = 100000;
+constexpr std::size_t GrowRows = 4096;
+constexpr int Runs = 30;
+
+template <typename T>
+void Fill (ComponentVector<T>& vec, std::size_t rows) {
+    for (std::size_t i = 0; i < rows; i++) {
+        vec.emplace();
+    }
+}
+
+template <typename T>
+void Run (const std::string& name) {
+    // Rows leave from the front, as entities do when moving archetype, so remove() swaps the last row in each time
+    double move = 0;
+    double clear = 0;
+    ComponentVector<T> source;
+    Fill(source, Rows);
+    for (int run = 0; run < Runs; run++) {
+        ComponentVector<T> from;
+        ComponentVector<T> to;
+        from.copyFrom(source);
+        auto moveTime = bench::Time([&] {
+            for (std::size_t i = 0; i < Rows; i++) {
+                to.moveFrom(from, 0);
+                from.remove(0);
+            }
+        });
+        auto clearTime = bench::Time([&] { to.clear(); });
+        move = run ? std::min(move, moveTime) : moveTime;
+        clear = run ? std::min(clear, clearTime) : clearTime;
+    }
+    bench::Report(name + " move rows", move);
+    bench::Report(name + " clear", clear);
+
+    ComponentVector<T> copy;
+    auto copyFrom = bench::BestOf(Runs, [&] { copy.copyFrom(source); });
+    bench::Report(name + " copyFrom", copyFrom);
+
+    auto grow = bench::BestOf(Runs, [] {
+        ComponentVector<T> vec{1};
+        Fill(vec, GrowRows);
+    });
+    bench::Report(name + " grow first chunk", grow);
+}
+} // namespace
+
+// Times the row operations archetype moves, snapshots and growth rely on, for a trivially copyable component and for
+// one of the same size with user-provided operations. Rows of both are moved through the virtual component operations,
+// which for trivially copyable components inline to plain copies
+int main () {
+    Run<Trivial>("trivial");
+    Run<Typed>("typed");
+}
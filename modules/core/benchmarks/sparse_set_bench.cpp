@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "core/world.h"
+
+#include <string>
+
+using namespace phenyl::core;
+
+namespace {
+struct Position {
+    float x = 0, y = 0;
+};
+
+struct Velocity {
+    float x = 1, y = 1;
+};
+
+struct Stunned {
+    int frames = 3;
+};
+
+constexpr std::size_t Entities = 20000;
+constexpr std::size_t ChurnPerFrame = 5000;
+constexpr int Frames = 100;
+constexpr int Runs = 5;
+
+void Run (ComponentStorage storage, const std::string& name) {
+    World world;
+    world.addComponent<Position>("Position");
+    world.addComponent<Velocity>("Velocity");
+    world.addComponent<Stunned>("Stunned", storage);
+
+    auto entities = world.spawnBatch(Entities, Position{}, Velocity{});
+    auto move = world.query<Position, const Velocity>();
+    auto stunned = world.query<Position, const Stunned>();
+
+    // Stuns a rotating subset of entities for a frame, which moves them between archetypes with archetype storage
+    auto churn = bench::BestOf(Runs, [&] {
+        for (int frame = 0; frame < Frames; frame++) {
+            for (std::size_t i = 0; i < ChurnPerFrame; i++) {
+                entities[(i * 7 + static_cast<std::size_t>(frame) * 131) % Entities].insert(Stunned{});
+            }
+            move.each([] (Position& pos, const Velocity& vel) {
+                pos.x += vel.x;
+                pos.y += vel.y;
+            });
+            for (std::size_t i = 0; i < ChurnPerFrame; i++) {
+                entities[(i * 7 + static_cast<std::size_t>(frame) * 131) % Entities].erase<Stunned>();
+            }
+        }
+    });
+    bench::Report(name + " churn frame", churn / Frames);
+
+    // Iterating the component itself is where sparse sets pay, as rows are looked up per entity
+    for (std::size_t i = 0; i < Entities; i += 4) {
+        entities[i].insert(Stunned{});
+    }
+    float sum = 0;
+    auto iterate = bench::BestOf(Runs * 4, [&] {
+        stunned.each([&] (Position& pos, const Stunned& stun) { sum += pos.x + static_cast<float>(stun.frames); });
+    });
+    bench::Report(name + " iterate", iterate);
+    if (sum < 0) {
+        bench::Report("unreachable", sum);
+    }
+}
+} // namespace
+
+// Compares archetype and sparse set storage for a component that is inserted and erased every frame
+int main () {
+    Run(ComponentStorage::Archetype, "archetype");
+    Run(ComponentStorage::SparseSet, "sparse set");
+}
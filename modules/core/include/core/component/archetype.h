@@ -10,9 +10,15 @@
 
 #include <compare>
 #include <map>
+#include <span>
 #include <unordered_map>
 
 namespace phenyl::core {
+namespace detail {
+    class ChangeFilterView;
+}
+class QueryArchetypes;
+
 class Archetype {
 public:
     Archetype (detail::IArchetypeManager& manager,
@@ -40,6 +46,10 @@ public:
         return m_entityIds.size();
     }
 
+    [[nodiscard]] std::span<const EntityId> entityIds () const noexcept {
+        return m_entityIds;
+    }
+
     template <typename T>
     T& get (std::size_t pos) {
         auto* obj = tryGet<T>(pos);
@@ -54,13 +64,21 @@ public:
         return *obj;
     }
 
+    // Mutable access marks the component as changed
     template <typename T>
     T* tryGet (std::size_t pos) {
         PHENYL_DASSERT(pos < size());
         // auto* comp = tryGetComponent<T>();
         // return comp ? &(*comp)[pos] : nullptr;
         auto* vec = tryGetVector(meta::TypeIndex::Get<T>());
-        return vec ? reinterpret_cast<T*>(vec->getUntyped(pos)) : nullptr;
+        if (!vec) {
+            return nullptr;
+        }
+
+        if constexpr (!std::is_const_v<T>) {
+            vec->markChanged(pos, changeTick());
+        }
+        return reinterpret_cast<T*>(vec->getUntyped(pos));
     }
 
     template <typename T>
@@ -73,6 +91,8 @@ public:
     }
 
     void remove (std::size_t pos);
+    // Removes several rows, going through each column once. Sorts positions
+    void removeRows (std::vector<std::size_t>& positions);
 
     template <typename T, typename... Args>
     void addComponent (std::size_t pos, Args&&... args) {
@@ -83,6 +103,27 @@ public:
         dest.initComp<std::remove_cvref_t<T>>(std::forward<Args>(args)...);
     }
 
+    // Adds all of the components with a single move. OnInsert is left to the caller, as the first handler may move the
+    // entity again
+    template <typename... Ts>
+    std::size_t addComponents (std::size_t pos, Ts&&... comps) {
+        PHENYL_DASSERT(pos < size());
+        static const auto AddedKey = detail::ArchetypeKey::Make<std::remove_cvref_t<Ts>...>();
+        PHENYL_DASSERT_MSG(AddedKey.unique(), "Duplicate component types passed to addComponents()");
+        PHENYL_DASSERT_MSG((!has<std::remove_cvref_t<Ts>>() && ...),
+            "Component already present in archetype passed to addComponents()");
+
+        Archetype& dest = getWith(AddedKey);
+        auto newPos = dest.moveFrom(*this, pos);
+        remove(pos);
+
+        auto tick = changeTick();
+        ((dest.getComponent<std::remove_cvref_t<Ts>>().emplace(std::forward<Ts>(comps)),
+             dest.getComponent<std::remove_cvref_t<Ts>>().markAdded(newPos, tick)),
+            ...);
+        return newPos;
+    }
+
     template <typename T>
     void removeComponent (std::size_t pos) {
         PHENYL_DASSERT(pos < size());
@@ -99,17 +140,30 @@ public:
     }
 
     void clear ();
+    // Frees storage not needed for the current rows and drops the cached transitions, which are rebuilt on demand
+    void shrinkToFit ();
+
+    // Number of cached transitions to other archetypes
+    [[nodiscard]] std::size_t edges () const noexcept {
+        return m_addArchetypes.size() + m_removeArchetypes.size() + m_addSetArchetypes.size() +
+            m_removeSetArchetypes.size();
+    }
 
     const detail::ArchetypeKey& getKey () const noexcept {
         return m_key;
     }
 
-    void instantiatePrefab (const detail::PrefabFactories& factories, std::size_t pos);
+    void instantiatePrefab (const detail::PrefabFactories& factories, const detail::ArchetypeKey& key, std::size_t pos);
+
+    [[nodiscard]] std::uint32_t changeTick () const noexcept {
+        return m_manager.changeTick();
+    }
 
 protected:
     Archetype (detail::IArchetypeManager& manager);
 
     std::size_t addEntity (EntityId id);
+    void reserve (std::size_t capacity);
 
 private:
     detail::IArchetypeManager& m_manager;
@@ -121,6 +175,12 @@ private:
 
     std::unordered_map<meta::TypeIndex, Archetype*> m_addArchetypes;
     std::unordered_map<meta::TypeIndex, Archetype*> m_removeArchetypes;
+    // Edges for adding several components at once, keyed by the added components
+    std::unordered_map<detail::ArchetypeKey, Archetype*> m_addSetArchetypes;
+    // Edges for removing several components at once, keyed by the removed components
+    std::unordered_map<detail::ArchetypeKey, Archetype*> m_removeSetArchetypes;
+    // Indexed by query id, whether the query matches this archetype
+    std::vector<bool> m_queryMarks;
 
     template <typename T>
     ComponentVector<std::remove_cvref_t<T>>& getComponent () {
@@ -200,20 +260,34 @@ private:
         return *archetype;
     }
 
+    Archetype& getWith (const detail::ArchetypeKey& addedKey);
+    Archetype& getWithout (const detail::ArchetypeKey& removedKey);
+
     template <typename T, typename... Args>
     void initComp (Args&&... args) {
         ComponentVector<T>& comp = getComponent<T>();
         auto* ptr = comp.emplace(std::forward<Args>(args)...);
+        comp.markAdded(comp.size() - 1, changeTick());
 
         m_manager.onComponentInsert(m_entityIds.back(), meta::TypeIndex::Get<T>(), reinterpret_cast<std::byte*>(ptr));
     }
 
     std::size_t moveFrom (Archetype& other, std::size_t pos);
+
+    [[nodiscard]] bool inQuery (std::size_t queryId) const noexcept {
+        return queryId < m_queryMarks.size() && m_queryMarks[queryId];
+    }
+
+    void markQuery (std::size_t queryId, bool matches);
+    // Marks every component of the row as added at the current tick
+    void markAdded (std::size_t pos);
     void instantiateInto (const detail::PrefabFactories& factories, std::size_t pos);
 
     template <typename... Args>
     friend class ArchetypeView;
     friend class World;
+    friend detail::ChangeFilterView;
+    friend QueryArchetypes;
 };
 
 class EmptyArchetype : public Archetype {
@@ -46,6 +46,7 @@ public:
         Iterator () = default;
 
         value_type operator* () const {
+            view->markChanged(pos);
             return {view->get<Args>()[pos]...};
         }
 
@@ -98,6 +99,7 @@ public:
         }
 
         value_type operator[] (difference_type n) const {
+            view->markChanged(pos + n);
             return value_type{view->get<Args>()[pos + n]...};
         }
 
@@ -130,6 +132,7 @@ public:
         BundleIterator () = default;
 
         value_type operator* () const {
+            view->markChanged(pos);
             return value_type{Entity{view->archetype.m_entityIds[pos], view->manager},
               std::tuple<Args&...>{view->get<Args>()[pos]...}};
         }
@@ -183,6 +186,7 @@ public:
         }
 
         value_type operator[] (difference_type n) const {
+            view->markChanged(pos + n);
             return value_type{Entity{view->archetype.m_entityIds[pos + n], view->manager},
               std::tuple<Args&...>{view->get<Args>()[pos + n]...}};
         }
@@ -213,6 +217,7 @@ public:
     explicit ArchetypeView (Archetype& archetype, World* manager) :
         archetype{archetype},
         manager{manager},
+        tick{archetype.changeTick()},
         components{archetype.getComponentView<std::remove_reference_t<Args>>(meta::TypeIndex::Get<Args>())...} {}
 
     [[nodiscard]] std::size_t size () const noexcept {
@@ -220,6 +225,12 @@ public:
     }
 
     Bundle<Args...> bundle (std::size_t pos) {
+        markChanged(pos);
+        return {Entity{archetype.m_entityIds[pos], manager}, std::tuple<Args&...>{get<Args>()[pos]...}};
+    }
+
+    // Same as bundle() but leaves the row unmarked, for rows that are only read from
+    Bundle<Args...> readBundle (std::size_t pos) {
         return {Entity{archetype.m_entityIds[pos], manager}, std::tuple<Args&...>{get<Args>()[pos]...}};
     }
 
@@ -238,6 +249,7 @@ public:
 private:
     Archetype& archetype;
     World* manager;
+    std::uint32_t tick;
     std::tuple<ComponentView<std::remove_reference_t<Args>>...> components;
 
     template <typename T>
@@ -249,5 +261,17 @@ private:
     const ComponentView<T>& get () const {
         return std::get<ComponentView<std::remove_reference_t<T>>>(components);
     }
+
+    // Rows handed out with mutable access to a component are marked as changed
+    void markChanged (std::size_t pos) {
+        (markChanged<Args>(pos), ...);
+    }
+
+    template <typename T>
+    void markChanged (std::size_t pos) {
+        if constexpr (!std::is_const_v<std::remove_reference_t<T>>) {
+            get<T>().markChanged(pos, tick);
+        }
+    }
 };
 } // namespace phenyl::core
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "core/entity_id.h"
+#include "util/arena.h"
+
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace phenyl::core {
+class World;
+
+// Records structural changes to entities to be run later. Each command is stored with its arguments in a bump arena
+// rather than in a heap allocated closure, and the arena is kept between runs. While deferred, entities record their
+// changes in the command buffer of the calling thread, which the world runs at the outermost deferEnd()
+class CommandBuffer {
+public:
+    CommandBuffer () = default;
+    ~CommandBuffer ();
+
+    CommandBuffer (const CommandBuffer&) = delete;
+    CommandBuffer (CommandBuffer&&) = delete;
+
+    CommandBuffer& operator= (const CommandBuffer&) = delete;
+    CommandBuffer& operator= (CommandBuffer&&) = delete;
+
+    [[nodiscard]] bool empty () const noexcept {
+        return !m_head;
+    }
+
+    [[nodiscard]] std::size_t size () const noexcept {
+        return m_size;
+    }
+
+    template <typename T>
+    void insert (EntityId id, T&& comp) {
+        emplace<T>(id, std::forward<T>(comp));
+    }
+
+    template <typename T, typename... Args>
+    void emplace (EntityId id, Args&&... args) {
+        using Comp = std::remove_cvref_t<T>;
+        record(id, [comp = Comp{std::forward<Args>(args)...}] (auto& world, EntityId entityId) mutable {
+            world.entity(entityId).insert(std::move(comp));
+        });
+    }
+
+    template <typename... Ts>
+    void insertAll (EntityId id, Ts&&... comps) {
+        record(id, [... comps = std::remove_cvref_t<Ts>{std::forward<Ts>(comps)}] (auto& world,
+                       EntityId entityId) mutable { world.entity(entityId).insertAll(std::move(comps)...); });
+    }
+
+    template <typename T>
+    void erase (EntityId id) {
+        record(id, [] (auto& world, EntityId entityId) { world.entity(entityId).template erase<T>(); });
+    }
+
+    template <typename... Ts>
+    void eraseAll (EntityId id) {
+        record(id, [] (auto& world, EntityId entityId) { world.entity(entityId).template eraseAll<Ts...>(); });
+    }
+
+    // Calls func with the entity's T, if it still has one when the command is run
+    template <typename T, std::invocable<T&> F>
+    void apply (EntityId id, F&& func) {
+        record(id, [func = std::forward<F>(func)] (auto& world, EntityId entityId) mutable {
+            world.entity(entityId).template apply<T>(std::move(func));
+        });
+    }
+
+    void remove (EntityId id);
+
+    // Runs the commands in the order they were recorded and clears the buffer. Commands for entities that no longer
+    // exist are skipped
+    void run (World& world);
+    // Drops all commands without running them
+    void clear ();
+
+private:
+    struct Command {
+        void (*run) (Command* command, World& world);
+        // Null for trivially destructible commands
+        void (*destroy) (Command* command) noexcept;
+        Command* next;
+        EntityId id;
+        // Path of parallel regions and tasks the command was recorded in, compared lexicographically
+        const std::uint32_t* order;
+        std::uint32_t orderSize;
+    };
+
+    template <typename F>
+    struct TypedCommand : Command {
+        F func;
+
+        static void Run (Command* command, World& world) {
+            auto* typed = static_cast<TypedCommand*>(command);
+            typed->func(world, typed->id);
+        }
+
+        static void Destroy (Command* command) noexcept {
+            static_cast<TypedCommand*>(command)->~TypedCommand();
+        }
+    };
+
+    util::Arena m_arena;
+    Command* m_head = nullptr;
+    Command* m_tail = nullptr;
+    std::size_t m_size = 0;
+    // Set by the world at the start and end of each parallel region
+    std::uint32_t m_epoch = 0;
+    // Number of runs in progress, as commands may end up running the buffer again
+    std::uint32_t m_runDepth = 0;
+
+    template <typename F>
+    void record (EntityId id, F&& func) {
+        using Func = std::remove_cvref_t<F>;
+        auto order = nextOrder();
+        Command header{
+          .run = &TypedCommand<Func>::Run,
+          .destroy = std::is_trivially_destructible_v<Func> ? nullptr : &TypedCommand<Func>::Destroy,
+          .next = nullptr,
+          .id = id,
+          .order = order.data(),
+          .orderSize = static_cast<std::uint32_t>(order.size()),
+        };
+        append(m_arena.make<TypedCommand<Func>>(header, std::forward<F>(func)));
+    }
+
+    // Copies the order key of the calling thread into the arena
+    [[nodiscard]] std::span<const std::uint32_t> nextOrder ();
+    void append (Command* command) noexcept;
+    // Takes the commands out of the buffer, so that commands recorded while they run start a new list
+    Command* takeCommands () noexcept;
+    // Reuses the arena once no run still holds commands from it
+    void finishRun () noexcept;
+
+    // Runs the commands of several buffers as if they had been recorded by a single thread running every task in
+    // order, so the result does not depend on which thread ran which task
+    static void RunMerged (std::span<CommandBuffer* const> buffers, World& world);
+    static void RunCommand (Command* command, World& world);
+
+    // Runs task(i) of a parallel region, ordering the commands it records after those of the region's earlier tasks.
+    // regionOrder sorts after the commands recorded before the region and before those recorded after it
+    static void RunTask (std::span<const std::uint32_t> regionOrder, std::size_t i,
+        const std::function<void(std::size_t)>& task);
+    // Moves the order of the calling task past a nested region it is starting, returning the order key of the region
+    static std::vector<std::uint32_t> BeginNestedRegion ();
+    static void EndNestedRegion ();
+
+    friend World;
+};
+} // namespace phenyl::core
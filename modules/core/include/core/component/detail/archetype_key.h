@@ -12,7 +12,9 @@ class ArchetypeKey {
 public:
     ArchetypeKey () = default;
 
-    explicit ArchetypeKey (std::vector<meta::TypeIndex> compIds) : m_compIds{std::move(compIds)} {}
+    explicit ArchetypeKey (std::vector<meta::TypeIndex> compIds) :
+        m_compIds{std::move(compIds)},
+        m_hash{Hash(m_compIds)} {}
 
     template <std::forward_iterator It, std::sentinel_for<It> S>
     explicit ArchetypeKey(It first, S last) : ArchetypeKey{std::vector<meta::TypeIndex>{first, last}} {}
@@ -45,14 +47,14 @@ public:
     }
 
     template <std::forward_iterator It, std::sentinel_for<It> S>
-    ArchetypeKey with (It it, S last) {
+    ArchetypeKey with (It it, S last) const {
         std::vector<meta::TypeIndex> newIds;
         std::set_union(m_compIds.begin(), m_compIds.end(), it, last, std::back_inserter(newIds));
         return ArchetypeKey{std::move(newIds)};
     }
 
     template <std::ranges::forward_range R>
-    ArchetypeKey with (R&& range) {
+    ArchetypeKey with (R&& range) const {
         std::vector<meta::TypeIndex> newIds;
         std::ranges::set_union(m_compIds, range, std::back_inserter(newIds));
         return ArchetypeKey{std::move(newIds)};
@@ -83,6 +85,13 @@ public:
         return ArchetypeKey{std::move(newIds)};
     }
 
+    [[nodiscard]] ArchetypeKey keyDifference (const ArchetypeKey& other) const {
+        std::vector<meta::TypeIndex> newIds;
+        std::ranges::set_difference(m_compIds, other.m_compIds, std::back_inserter(newIds));
+
+        return ArchetypeKey{std::move(newIds)};
+    }
+
     [[nodiscard]] ArchetypeKey keyIntersection (const ArchetypeKey& other) const {
         std::vector<meta::TypeIndex> newIds;
         std::ranges::set_intersection(m_compIds, other.m_compIds, std::back_inserter(newIds));
@@ -99,7 +108,20 @@ public:
     }
 
     bool operator== (const ArchetypeKey& other) const {
-        return m_compIds == other.m_compIds;
+        return m_hash == other.m_hash && m_compIds == other.m_compIds;
+    }
+
+    [[nodiscard]] std::size_t hash () const noexcept {
+        return m_hash;
+    }
+
+    [[nodiscard]] std::size_t size () const noexcept {
+        return m_compIds.size();
+    }
+
+    // Whether no type appears more than once, which keys built from lists of types do not check
+    [[nodiscard]] bool unique () const noexcept {
+        return std::ranges::adjacent_find(m_compIds) == m_compIds.end();
     }
 
     auto begin () const {
@@ -121,5 +143,23 @@ public:
 private:
     // Sorted vector of component type ids
     std::vector<meta::TypeIndex> m_compIds;
+    // Precomputed as keys are looked up far more often than they are made
+    std::size_t m_hash = 0;
+
+    static std::size_t Hash (const std::vector<meta::TypeIndex>& compIds) noexcept {
+        std::size_t hash = compIds.size();
+        for (auto id : compIds) {
+            hash ^= id.hash() + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+
+        return hash;
+    }
 };
 } // namespace phenyl::core::detail
+
+template <>
+struct std::hash<phenyl::core::detail::ArchetypeKey> {
+    std::size_t operator() (const phenyl::core::detail::ArchetypeKey& key) const noexcept {
+        return key.hash();
+    }
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace phenyl::core::detail {
+// Change ticks wrap around, so are only compared relative to each other. The world clamps stored ticks older than
+// MaxTickAge every TickCheckInterval ticks, so no stored tick is ever more than StaleTickAge old
+inline constexpr std::uint32_t MaxTickAge = std::uint32_t{1} << 30;
+inline constexpr std::uint32_t TickCheckInterval = std::uint32_t{1} << 29;
+inline constexpr std::uint32_t StaleTickAge = MaxTickAge + TickCheckInterval;
+
+// Whether tick is after since. Only valid while the ticks are less than half the tick range apart
+constexpr bool TickNewer (std::uint32_t tick, std::uint32_t since) noexcept {
+    return tick != since && tick - since < UINT32_MAX / 2;
+}
+
+// Brings a tick older than maxAge forward to now - maxAge
+constexpr std::uint32_t ClampTick (std::uint32_t tick, std::uint32_t now, std::uint32_t maxAge) noexcept {
+    return now - tick > maxAge ? now - maxAge : tick;
+}
+} // namespace phenyl::core::detail
@@ -43,10 +43,6 @@ public:
     virtual void onInsert (EntityId id, std::byte* comp) = 0;
     virtual void onRemove (EntityId id, std::byte* comp) = 0;
 
-    virtual void deferComp (EntityId id, std::byte* comp) = 0;
-    virtual void deferErase (EntityId id) = 0;
-    virtual void deferEnd () = 0;
-
 protected:
     [[nodiscard]] Entity entity (EntityId id) const noexcept {
         return Entity{id, m_world};
@@ -92,33 +88,8 @@ public:
         }
     }
 
-    void deferComp (EntityId id, std::byte* comp) override {
-        auto* typedComp = reinterpret_cast<T*>(comp);
-        m_deferredInserts.emplace_back(id, std::move(*typedComp));
-    }
-
-    void deferErase (EntityId id) override {
-        m_deferredErases.emplace_back(id);
-    }
-
-    void deferEnd () override {
-        for (auto& [id, comp] : m_deferredInserts) {
-            entity(id).insert(std::move(comp));
-        }
-
-        for (auto id : m_deferredErases) {
-            entity(id).template erase<T>();
-        }
-
-        m_deferredInserts.clear();
-        m_deferredErases.clear();
-    }
-
 private:
     std::vector<std::function<void(const OnInsert<T>&, Entity)>> m_insertHandlers;
     std::vector<std::function<void(const OnRemove<T>&, Entity)>> m_removeHandlers;
-
-    std::vector<std::pair<EntityId, T>> m_deferredInserts;
-    std::vector<EntityId> m_deferredErases;
 };
 } // namespace phenyl::core::detail
@@ -3,11 +3,24 @@
 #include "logging/logging.h"
 #include "util/type_index.h"
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 namespace phenyl::core {
+// Empty, trivial components only take part in archetype keys and have no per-row storage
+template <typename T>
+concept TagComponent = std::is_empty_v<T> && std::is_trivial_v<T>;
+
 class UntypedComponentVector {
 public:
+    // Rows are stored in chunks of about CHUNK_BYTES each, so growing never moves rows once the first chunk is full.
+    // The first chunk grows geometrically up to the full chunk size to keep small archetypes small
+    static constexpr std::size_t CHUNK_BYTES = 16 * 1024;
+
+    // A dataSize of 0 makes a tag vector, where every row shares a single address and no components are constructed,
+    // moved or destroyed
     UntypedComponentVector (meta::TypeIndex typeIndex, std::size_t dataSize, std::size_t startCapacity);
     virtual ~UntypedComponentVector () = default;
 
@@ -16,18 +29,59 @@ public:
 
     std::byte* getUntyped (std::size_t pos) {
         PHENYL_DASSERT(pos < size());
-        return m_memory.get() + (pos * m_compSize);
+        return m_chunks[pos >> m_chunkShift].get() + (pos & m_chunkMask) * m_compSize;
     }
 
     [[nodiscard]] const std::byte* getUntyped (std::size_t pos) const {
         PHENYL_DASSERT(pos < size());
-        return m_memory.get() + (pos * m_compSize);
+        return m_chunks[pos >> m_chunkShift].get() + (pos & m_chunkMask) * m_compSize;
     }
 
     std::byte* insertUntyped ();
+    void reserve (std::size_t capacity);
     void moveFrom (UntypedComponentVector& other, std::size_t pos);
+    // Replaces the rows and their ticks with copies of those in other, reusing the allocated chunks
+    void copyFrom (const UntypedComponentVector& other);
     void remove (std::size_t pos);
     void clear ();
+    // Frees the chunks and tick storage not needed for the current rows
+    void shrinkToFit ();
+
+    // Change ticks of each row. Rows start with tick 0 until marked by the owning archetype
+    [[nodiscard]] std::uint32_t addedTick (std::size_t pos) const noexcept {
+        PHENYL_DASSERT(pos < size());
+        return m_addedTicks[pos];
+    }
+
+    [[nodiscard]] std::uint32_t changedTick (std::size_t pos) const noexcept {
+        PHENYL_DASSERT(pos < size());
+        return m_changedTicks[pos];
+    }
+
+    [[nodiscard]] const std::uint32_t* addedTicks () const noexcept {
+        return m_addedTicks.data();
+    }
+
+    [[nodiscard]] const std::uint32_t* changedTicks () const noexcept {
+        return m_changedTicks.data();
+    }
+
+    void markAdded (std::size_t pos, std::uint32_t tick) noexcept {
+        PHENYL_DASSERT(pos < size());
+        m_addedTicks[pos] = tick;
+        m_changedTicks[pos] = tick;
+    }
+
+    void markChanged (std::size_t pos, std::uint32_t tick) noexcept {
+        PHENYL_DASSERT(pos < size());
+        m_changedTicks[pos] = tick;
+    }
+
+    void markAllChanged (std::uint32_t tick) noexcept;
+    // Brings ticks more than maxAge behind now forward, so that they still compare as older after the tick wraps
+    void clampTicks (std::uint32_t now, std::uint32_t maxAge) noexcept;
+    // Whether any row has been changed after tick
+    [[nodiscard]] bool changedSince (std::uint32_t tick) const noexcept;
 
     [[nodiscard]] meta::TypeIndex type () const noexcept {
         return m_type;
@@ -45,40 +99,52 @@ public:
         return m_compSize;
     }
 
+    [[nodiscard]] bool isTag () const noexcept {
+        return !m_compSize;
+    }
+
+    // Bytes taken up by the rows and their ticks
+    [[nodiscard]] std::size_t usedBytes () const noexcept {
+        return m_size * (m_compSize + sizeof(std::uint32_t) * 2);
+    }
+
+    // Bytes allocated for rows and their ticks
+    [[nodiscard]] std::size_t reservedBytes () const noexcept {
+        return m_capacity * m_compSize + (m_addedTicks.capacity() + m_changedTicks.capacity()) * sizeof(std::uint32_t);
+    }
+
+    // Number of rows in each full chunk
+    [[nodiscard]] std::size_t chunkRows () const noexcept {
+        return m_chunkMask + 1;
+    }
+
     virtual std::unique_ptr<UntypedComponentVector> makeNew (std::size_t startCapacity = 16) const = 0;
+    // Whether copyFrom() is supported, which needs the component to be copy constructible
+    [[nodiscard]] virtual bool copyable () const noexcept = 0;
 
 protected:
     virtual void moveComp (std::byte* from, std::byte* to) = 0;
     virtual void moveConstructComp (std::byte* from, std::byte* to) = 0;
     virtual void deleteComp (std::byte* comp) = 0;
     virtual void moveAllComps (std::byte* start, std::byte* end, std::byte* newStart) = 0;
+    // Copy constructs the components in [start, end) into uninitialised memory at newStart
+    virtual void copyAllComps (const std::byte* start, const std::byte* end, std::byte* newStart) = 0;
     virtual void deleteAllComps (std::byte* start, std::byte* end) = 0;
 
-    std::byte* beginUntyped () {
-        return m_memory.get();
-    }
-
-    [[nodiscard]] const std::byte* beginUntyped () const {
-        return m_memory.get();
-    }
-
-    std::byte* endUntyped () {
-        return m_memory.get() + (m_size * m_compSize);
-    }
-
-    const std::byte* endUntyped () const {
-        return m_memory.get() + (m_size * m_compSize);
-    }
-
 private:
     static constexpr std::size_t RESIZE_FACTOR = 2;
 
     meta::TypeIndex m_type;
 
-    std::unique_ptr<std::byte[]> m_memory;
+    std::vector<std::unique_ptr<std::byte[]>> m_chunks;
     std::size_t m_compSize;
     std::size_t m_size;
     std::size_t m_capacity;
+    std::size_t m_chunkShift;
+    std::size_t m_chunkMask;
+
+    std::vector<std::uint32_t> m_addedTicks;
+    std::vector<std::uint32_t> m_changedTicks;
 
     void guaranteeLength (std::size_t newLen);
 };
@@ -86,19 +152,11 @@ private:
 template <typename T>
 class ComponentVector : public UntypedComponentVector {
 public:
-    using iterator = T*;
-    using const_iterator = const T*;
-
     explicit ComponentVector (std::size_t startCapacity = 16) :
-        UntypedComponentVector{meta::TypeIndex::Get<T>(), sizeof(T), startCapacity} {}
+        UntypedComponentVector{meta::TypeIndex::Get<T>(), TagComponent<T> ? 0 : sizeof(T), startCapacity} {}
 
     ~ComponentVector () override {
-        auto* start = reinterpret_cast<T*>(beginUntyped());
-        auto* end = reinterpret_cast<T*>(endUntyped());
-
-        for (auto* i = start; i < end; i++) {
-            i->~T();
-        }
+        clear();
     }
 
     template <typename... Args>
@@ -106,7 +164,9 @@ public:
     {
         T* ptr = reinterpret_cast<T*>(insertUntyped());
 
-        new (ptr) T(std::forward<Args>(args)...);
+        if constexpr (!TagComponent<T>) {
+            new (ptr) T(std::forward<Args>(args)...);
+        }
         return ptr;
     }
 
@@ -114,6 +174,10 @@ public:
         return std::make_unique<ComponentVector<T>>(startCapacity);
     }
 
+    [[nodiscard]] bool copyable () const noexcept override {
+        return std::is_copy_constructible_v<T>;
+    }
+
     T& operator[] (std::size_t pos) {
         return *reinterpret_cast<T*>(getUntyped(pos));
     }
@@ -122,30 +186,6 @@ public:
         return *reinterpret_cast<T*>(getUntyped(pos));
     }
 
-    iterator begin () {
-        return iterator{reinterpret_cast<T*>(beginUntyped())};
-    }
-
-    iterator end () {
-        return iterator{reinterpret_cast<T*>(endUntyped())};
-    }
-
-    const_iterator begin () const {
-        return cbegin();
-    }
-
-    const_iterator cbegin () const {
-        return const_iterator{reinterpret_cast<T*>(beginUntyped())};
-    }
-
-    const_iterator end () const {
-        return cend();
-    }
-
-    const_iterator cend () const {
-        return const_iterator{reinterpret_cast<T*>(endUntyped())};
-    }
-
 protected:
     void moveComp (std::byte* from, std::byte* to) override {
         auto* fromTyped = reinterpret_cast<T*>(from);
@@ -173,11 +213,27 @@ protected:
         auto* newStartTyped = reinterpret_cast<T*>(newStart);
 
         for (auto* i = startTyped; i < endTyped; i++) {
-            *(newStartTyped++) = std::move(*i);
+            new (newStartTyped++) T(std::move(*i));
             i->~T();
         }
     }
 
+    void copyAllComps (const std::byte* start, const std::byte* end, std::byte* newStart) override {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(newStart, start, static_cast<std::size_t>(end - start));
+        } else if constexpr (std::is_copy_constructible_v<T>) {
+            const auto* startTyped = reinterpret_cast<const T*>(start);
+            const auto* endTyped = reinterpret_cast<const T*>(end);
+            auto* newStartTyped = reinterpret_cast<T*>(newStart);
+
+            for (const auto* i = startTyped; i < endTyped; i++) {
+                new (newStartTyped++) T(*i);
+            }
+        } else {
+            PHENYL_ABORT("Attempted to copy component vector of non-copyable type");
+        }
+    }
+
     void deleteAllComps (std::byte* start, std::byte* end) override {
         auto* startTyped = reinterpret_cast<T*>(start);
         auto* endTyped = reinterpret_cast<T*>(end);
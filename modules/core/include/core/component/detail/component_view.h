@@ -114,6 +114,10 @@ public:
         return m_vec->size();
     }
 
+    void markChanged (std::size_t pos, std::uint32_t tick) const noexcept {
+        m_vec->markChanged(pos, tick);
+    }
+
     template <typename Base>
     requires (std::derived_from<T, Base> && (!std::is_const_v<T> || std::is_const_v<Base>) )
     ComponentView<Base> cast () const {
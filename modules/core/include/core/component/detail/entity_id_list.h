@@ -44,14 +44,30 @@ public:
     explicit EntityIdList (std::size_t capacity);
 
     EntityId newId ();
+    // Adds a new id after every existing one, ignoring freed ids
+    EntityId appendId ();
     [[nodiscard]] bool check (EntityId id) const;
 
     void removeId (EntityId id);
     void clear ();
 
+    void shrinkToFit () {
+        idSlots.shrink_to_fit();
+    }
+
     [[nodiscard]] std::size_t size () const;
     [[nodiscard]] std::size_t maxIndex () const;
 
+    [[nodiscard]] std::size_t usedBytes () const noexcept {
+        return idSlots.size() * sizeof(std::size_t);
+    }
+
+    [[nodiscard]] std::size_t reservedBytes () const noexcept {
+        return idSlots.capacity() * sizeof(std::size_t);
+    }
+
+    bool operator== (const EntityIdList& other) const = default;
+
     [[nodiscard]] iterator begin () const;
     [[nodiscard]] const_iterator cbegin () const;
 
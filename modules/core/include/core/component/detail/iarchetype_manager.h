@@ -1,6 +1,7 @@
 #pragma once
 #include "util/type_index.h"
 
+#include <cstdint>
 #include <set>
 
 namespace phenyl::core {
@@ -22,5 +23,7 @@ public:
 
     virtual void onComponentInsert (EntityId id, meta::TypeIndex compType, std::byte* ptr) = 0;
     virtual void onComponentRemove (EntityId id, meta::TypeIndex compType, std::byte* ptr) = 0;
+
+    virtual std::uint32_t changeTick () const noexcept = 0;
 };
 } // namespace phenyl::core::detail
@@ -1,14 +1,29 @@
 #pragma once
 
+#include "change_tick.h"
 #include "core/entity_id.h"
 #include "logging/logging.h"
 #include "util/iterable.h"
 
 #include <cassert>
 #include <iterator>
+#include <limits>
 #include <vector>
 
 namespace phenyl::core::detail {
+struct HierarchyEntry {
+    static constexpr std::uint32_t NoParent = std::numeric_limits<std::uint32_t>::max();
+
+    // Null for entities removed since the last rebuild
+    EntityId id;
+    // Index of the parent entry, which always comes before this one
+    std::uint32_t parent;
+    // Change tick the entity was created or last reparented at
+    std::uint32_t parentTick;
+
+    bool operator== (const HierarchyEntry& other) const = default;
+};
+
 class RelationshipManager {
 public:
     class ChildIterator {
@@ -54,26 +69,41 @@ public:
         m_relationships.push_back(Relationship{});
     }
 
-    void add (EntityId id, EntityId parent) {
-        PHENYL_DASSERT(m_relationships.size() >= id.m_id);
+    void add (EntityId id, EntityId parent, std::uint32_t tick) {
+        // Ids reserved up front (e.g. deferred batches) may be added out of order
         if (m_relationships.size() <= id.m_id) {
-            m_relationships.push_back(Relationship{});
+            m_relationships.resize(id.m_id + 1);
         }
 
-        setParent(id, parent);
-    }
+        link(id, parent, tick);
+        if (m_hierarchyDirty) {
+            return;
+        }
 
-    void setParent (EntityId id, EntityId parent) {
-        getRelationship(id).parent = parent;
+        auto parentIndex = hierarchyIndex(parent);
+        if (parent && parentIndex == NoIndex) {
+            m_hierarchyDirty = true;
+        } else {
+            getRelationship(id).hierarchyIndex = static_cast<std::uint32_t>(m_hierarchy.size());
+            m_hierarchy.emplace_back(id, parentIndex, tick);
+        }
+    }
 
-        // Add to start of linked list
-        auto oldStart = getRelationship(parent).children;
+    void setParent (EntityId id, EntityId parent, std::uint32_t tick) {
+        link(id, parent, tick);
+        if (m_hierarchyDirty) {
+            return;
+        }
 
-        getRelationship(id).next = oldStart;
-        if (oldStart) {
-            getRelationship(oldStart).prev = id;
+        // Parent entries must stay before their children, otherwise fall back to a rebuild
+        auto index = getRelationship(id).hierarchyIndex;
+        auto parentIndex = hierarchyIndex(parent);
+        if (parent && (parentIndex == NoIndex || parentIndex > index)) {
+            m_hierarchyDirty = true;
+        } else {
+            m_hierarchy[index].parent = parentIndex;
+            m_hierarchy[index].parentTick = tick;
         }
-        getRelationship(parent).children = id;
     }
 
     void removeFromParent (EntityId id) {
@@ -99,7 +129,12 @@ public:
             removeFromParent(id);
         }
 
-        getRelationship(id).clear();
+        auto& rel = getRelationship(id);
+        if (rel.hierarchyIndex != NoIndex) {
+            m_hierarchy[rel.hierarchyIndex].id = EntityId{};
+            m_hierarchyRemoved++;
+        }
+        rel.clear();
     }
 
     [[nodiscard]] EntityId parent (EntityId id) const {
@@ -126,11 +161,54 @@ public:
         return ChildIterator{this, EntityId{}};
     }
 
+    void shrinkToFit () {
+        m_relationships.shrink_to_fit();
+        m_hierarchy.shrink_to_fit();
+    }
+
     void reset () {
         m_relationships.clear();
         m_relationships.push_back(Relationship{});
+        m_hierarchy.clear();
+        m_hierarchyRemoved = 0;
+        m_hierarchyDirty = false;
     }
 
+    // Flattened hierarchy where parents always come before their children. New entities are appended, and the list is
+    // rebuilt sorted by depth on reparents that would break the ordering or once enough entities have been removed
+    const std::vector<HierarchyEntry>& hierarchy () {
+        if (m_hierarchyDirty || m_hierarchyRemoved > m_hierarchy.size() / 2) {
+            rebuildHierarchy();
+        }
+
+        return m_hierarchy;
+    }
+
+    // Index of the entity in hierarchy(), only valid until the hierarchy next changes
+    [[nodiscard]] std::uint32_t hierarchyIndex (EntityId id) const {
+        return id ? getRelationship(id).hierarchyIndex : HierarchyEntry::NoParent;
+    }
+
+    // Brings parent ticks more than maxAge behind now forward
+    void clampTicks (std::uint32_t now, std::uint32_t maxAge) noexcept {
+        for (auto& relationship : m_relationships) {
+            relationship.parentTick = ClampTick(relationship.parentTick, now, maxAge);
+        }
+        for (auto& entry : m_hierarchy) {
+            entry.parentTick = ClampTick(entry.parentTick, now, maxAge);
+        }
+    }
+
+    [[nodiscard]] std::size_t usedBytes () const noexcept {
+        return m_relationships.size() * sizeof(Relationship) + m_hierarchy.size() * sizeof(HierarchyEntry);
+    }
+
+    [[nodiscard]] std::size_t reservedBytes () const noexcept {
+        return m_relationships.capacity() * sizeof(Relationship) + m_hierarchy.capacity() * sizeof(HierarchyEntry);
+    }
+
+    bool operator== (const RelationshipManager& other) const = default;
+
 private:
     struct Relationship {
         EntityId parent{};
@@ -140,16 +218,62 @@ private:
         EntityId next{};
         EntityId prev{};
 
+        std::uint32_t hierarchyIndex = NoIndex;
+        std::uint32_t parentTick = 0;
+
         void clear () {
             parent = {};
             children = {};
             next = {};
             prev = {};
+            hierarchyIndex = NoIndex;
+            parentTick = 0;
         }
+
+        bool operator== (const Relationship& other) const = default;
     };
 
+    static constexpr std::uint32_t NoIndex = HierarchyEntry::NoParent;
+
     std::vector<Relationship> m_relationships{};
 
+    std::vector<HierarchyEntry> m_hierarchy;
+    std::size_t m_hierarchyRemoved = 0;
+    bool m_hierarchyDirty = false;
+
+    void link (EntityId id, EntityId parent, std::uint32_t tick) {
+        getRelationship(id).parent = parent;
+        getRelationship(id).parentTick = tick;
+
+        // Add to start of linked list
+        auto oldStart = getRelationship(parent).children;
+
+        getRelationship(id).next = oldStart;
+        if (oldStart) {
+            getRelationship(oldStart).prev = id;
+        }
+        getRelationship(parent).children = id;
+    }
+
+    void rebuildHierarchy () {
+        m_hierarchy.clear();
+        for (auto child : children(EntityId{})) {
+            m_hierarchy.emplace_back(child, HierarchyEntry::NoParent, getRelationship(child).parentTick);
+        }
+
+        // Breadth first, so entries end up sorted by depth
+        for (std::size_t i = 0; i < m_hierarchy.size(); i++) {
+            auto id = m_hierarchy[i].id;
+            getRelationship(id).hierarchyIndex = static_cast<std::uint32_t>(i);
+            for (auto child : children(id)) {
+                m_hierarchy.emplace_back(child, static_cast<std::uint32_t>(i), getRelationship(child).parentTick);
+            }
+        }
+
+        m_hierarchyRemoved = 0;
+        m_hierarchyDirty = false;
+    }
+
     Relationship& getRelationship (EntityId id) {
         PHENYL_DASSERT(id.m_id < m_relationships.size());
 
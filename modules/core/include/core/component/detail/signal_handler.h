@@ -4,6 +4,9 @@
 #include "core/component/query.h"
 #include "core/entity.h"
 
+#include <algorithm>
+#include <span>
+
 namespace phenyl::core {
 class World;
 }
@@ -14,31 +17,43 @@ class ISignalHandler {
 public:
     virtual ~ISignalHandler () = default;
     virtual void handle (Entity entity, const Signal& signal) const = 0;
+    // Handles signals[i] raised on the entity in row positions[i] of archetype, for each i
+    virtual void handleRows (Archetype& archetype, std::span<const std::size_t> positions,
+        std::span<const Signal* const> signals) const = 0;
 };
 
-template <typename Signal, typename... Args>
+template <typename Signal, typename F, typename... Args>
 class SignalHandler2 : public ISignalHandler<Signal> {
 public:
-    SignalHandler2 (Query<Args...> query, std::function<void(const Signal&, const Bundle<Args...>&)> func) :
-        m_query{std::move(query)},
-        m_func{std::move(func)} {}
+    SignalHandler2 (Query<Args...> query, F func) : m_query{std::move(query)}, m_func{std::move(func)} {}
 
     void handle (Entity entity, const Signal& signal) const override {
         m_query.entity(entity, [&] (const Bundle<Args...>& bundle) { m_func(signal, bundle); });
     }
 
+    void handleRows (Archetype& archetype, std::span<const std::size_t> positions,
+        std::span<const Signal* const> signals) const override {
+        m_query.rows(archetype, positions,
+            [&] (std::size_t i, const Bundle<Args...>& bundle) { m_func(*signals[i], bundle); });
+    }
+
 private:
     Query<Args...> m_query{};
-    std::function<void(const Signal&, const Bundle<Args...>&)> m_func;
+    mutable F m_func;
 };
 
 class IHandlerVector {
 public:
     virtual ~IHandlerVector () = default;
 
-    virtual void handle (EntityId id, std::byte* ptr) = 0;
+    // Returns whether the signal was dispatched immediately rather than deferred
+    virtual bool handle (EntityId id, std::byte* ptr) = 0;
     virtual void defer () = 0;
     virtual void deferEnd () = 0;
+
+    [[nodiscard]] virtual bool hasDeferred () const noexcept = 0;
+    // Dispatches the deferred signals, returning how many were dispatched. Structural changes must be deferred
+    virtual std::size_t dispatchDeferred () = 0;
 };
 
 template <typename Signal>
@@ -50,42 +65,113 @@ public:
         m_handlers.emplace_back(std::move(handler));
     }
 
-    void handle (EntityId id, std::byte* signal) override {
+    bool handle (EntityId id, std::byte* signal) override {
         // Assumes creation/update/deletion of components is deferred
 
         auto* typedSignal = reinterpret_cast<Signal*>(signal);
         if (m_isDeferred) {
             m_deferredSignals.emplace_back(id, std::move(*typedSignal));
-        } else {
-            handleSignal(Entity{id, &m_manager}, *typedSignal);
+            return false;
         }
+
+        handleSignal(Entity{id, &m_manager}, *typedSignal);
+        return true;
     }
 
     void defer () override {
-        PHENYL_DASSERT(m_deferredSignals.empty());
         m_isDeferred = true;
     }
 
     void deferEnd () override {
-        // Assumes creation/update/deletion of components/entities is deferred
         PHENYL_DASSERT(m_isDeferred);
         m_isDeferred = false;
+    }
 
-        for (auto& [id, signal] : m_deferredSignals) {
+    [[nodiscard]] bool hasDeferred () const noexcept override {
+        return !m_deferredSignals.empty();
+    }
+
+    std::size_t dispatchDeferred () override {
+        // Signals raised by handlers are kept for the next dispatch
+        std::swap(m_dispatching, m_deferredSignals);
+
+        // Signals are grouped by the archetype of their entity, in the order each archetype was first signalled
+        m_groups.clear();
+        m_targets.clear();
+        for (const auto& [id, signal] : m_dispatching) {
             Entity entity{id, &m_manager};
-            if (entity.exists()) {
-                handleSignal(entity, signal);
+            if (!entity.exists()) {
+                continue;
+            }
+
+            auto entry = entity.entry();
+            m_targets.emplace_back(group(entry.archetype), entry.pos, &signal);
+        }
+
+        // Counting sort, which keeps the signals of each archetype in the order they were raised
+        m_groupStarts.assign(m_groups.size() + 1, 0);
+        for (const auto& target : m_targets) {
+            m_groupStarts[target.group + 1]++;
+        }
+        for (std::size_t i = 1; i < m_groupStarts.size(); i++) {
+            m_groupStarts[i] += m_groupStarts[i - 1];
+        }
+
+        m_positions.resize(m_targets.size());
+        m_signals.resize(m_targets.size());
+        m_groupEnds.assign(m_groupStarts.begin(), m_groupStarts.end() - 1);
+        for (const auto& target : m_targets) {
+            auto index = m_groupEnds[target.group]++;
+            m_positions[index] = target.pos;
+            m_signals[index] = target.signal;
+        }
+
+        for (std::size_t i = 0; i < m_groups.size(); i++) {
+            auto start = m_groupStarts[i];
+            auto count = m_groupStarts[i + 1] - start;
+            for (const auto& handler : m_handlers) {
+                handler->handleRows(*m_groups[i], std::span{m_positions}.subspan(start, count),
+                    std::span{m_signals}.subspan(start, count));
             }
         }
-        m_deferredSignals.clear();
+
+        auto dispatched = m_targets.size();
+        m_dispatching.clear();
+        return dispatched;
     }
 
 private:
+    struct Target {
+        std::size_t group;
+        std::size_t pos;
+        const Signal* signal;
+    };
+
     World& m_manager;
     std::vector<std::unique_ptr<ISignalHandler<Signal>>> m_handlers;
     std::vector<std::pair<EntityId, Signal>> m_deferredSignals;
     bool m_isDeferred = false;
 
+    // Kept between dispatches to reuse their allocations
+    std::vector<std::pair<EntityId, Signal>> m_dispatching;
+    std::vector<Archetype*> m_groups;
+    std::vector<Target> m_targets;
+    std::vector<std::size_t> m_groupStarts;
+    std::vector<std::size_t> m_groupEnds;
+    std::vector<std::size_t> m_positions;
+    std::vector<const Signal*> m_signals;
+
+    std::size_t group (Archetype* archetype) {
+        // Signals usually target few archetypes, so a linear search is cheaper than hashing
+        auto it = std::ranges::find(m_groups, archetype);
+        if (it != m_groups.end()) {
+            return static_cast<std::size_t>(it - m_groups.begin());
+        }
+
+        m_groups.emplace_back(archetype);
+        return m_groups.size() - 1;
+    }
+
     void handleSignal (Entity entity, const Signal& signal) {
         PHENYL_DASSERT(entity.exists());
         for (const auto& i : m_handlers) {
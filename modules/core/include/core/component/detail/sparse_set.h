@@ -0,0 +1,133 @@
+#pragma once
+
+#include "component_vector.h"
+#include "core/entity_id.h"
+#include "iarchetype_manager.h"
+#include "prefab_factory.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace phenyl::core {
+// Where the instances of a component are kept
+enum class ComponentStorage {
+    // In archetype columns, which are fastest to iterate
+    Archetype,
+    // In a sparse set indexed by entity, so inserting and erasing never moves the entity to another archetype. Suited
+    // to components that are added and removed often
+    SparseSet
+};
+} // namespace phenyl::core
+
+namespace phenyl::core::detail {
+class SparseComponentSet {
+public:
+    static constexpr std::uint32_t NoIndex = std::numeric_limits<std::uint32_t>::max();
+
+    SparseComponentSet (IArchetypeManager& manager, std::unique_ptr<UntypedComponentVector> components);
+
+    [[nodiscard]] meta::TypeIndex type () const noexcept {
+        return m_components->type();
+    }
+
+    [[nodiscard]] std::size_t size () const noexcept {
+        return m_ids.size();
+    }
+
+    [[nodiscard]] EntityId id (std::size_t index) const noexcept {
+        PHENYL_DASSERT(index < size());
+        return m_ids[index];
+    }
+
+    // Dense index of the component of the entity, or NoIndex if it has none
+    [[nodiscard]] std::uint32_t index (EntityId id) const noexcept {
+        auto pos = id.pos();
+        if (pos >= m_sparse.size()) {
+            return NoIndex;
+        }
+
+        auto index = m_sparse[pos];
+        return index != NoIndex && m_ids[index] == id ? index : NoIndex;
+    }
+
+    [[nodiscard]] bool contains (EntityId id) const noexcept {
+        return index(id) != NoIndex;
+    }
+
+    [[nodiscard]] const UntypedComponentVector& components () const noexcept {
+        return *m_components;
+    }
+
+    // Mutable access marks the component as changed
+    template <typename T>
+    T* tryGet (EntityId id) {
+        auto i = index(id);
+        if (i == NoIndex) {
+            return nullptr;
+        }
+
+        if constexpr (!std::is_const_v<T>) {
+            m_components->markChanged(i, m_manager.changeTick());
+        }
+        return reinterpret_cast<T*>(m_components->getUntyped(i));
+    }
+
+    template <typename T>
+    const T* tryGet (EntityId id) const {
+        auto i = index(id);
+        return i != NoIndex ? reinterpret_cast<const T*>(m_components->getUntyped(i)) : nullptr;
+    }
+
+    template <typename T, typename... Args>
+    void emplace (EntityId id, Args&&... args) {
+        PHENYL_DASSERT(!contains(id));
+        auto* ptr = insertUntyped(id);
+        if constexpr (!TagComponent<T>) {
+            new (ptr) T(std::forward<Args>(args)...);
+        }
+        onInsert(id);
+    }
+
+    void make (EntityId id, const IPrefabFactory& factory);
+
+    // Raises OnRemove before removing the component
+    void erase (EntityId id);
+    // Removes without raising any signals, for entities being deleted
+    void remove (EntityId id);
+    void clear ();
+    // Replaces the contents with copies of those of other, without raising any signals
+    void copyFrom (const SparseComponentSet& other);
+    void shrinkToFit ();
+
+    void markAllChanged (std::uint32_t tick) noexcept {
+        m_components->markAllChanged(tick);
+    }
+
+    void clampTicks (std::uint32_t now, std::uint32_t maxAge) noexcept {
+        m_components->clampTicks(now, maxAge);
+    }
+
+    [[nodiscard]] std::size_t usedBytes () const noexcept {
+        return m_components->usedBytes() + m_ids.size() * sizeof(EntityId) + m_sparse.size() * sizeof(std::uint32_t);
+    }
+
+    [[nodiscard]] std::size_t reservedBytes () const noexcept {
+        return m_components->reservedBytes() + m_ids.capacity() * sizeof(EntityId) +
+            m_sparse.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    IArchetypeManager& m_manager;
+    std::unique_ptr<UntypedComponentVector> m_components;
+    // Dense index to entity
+    std::vector<EntityId> m_ids;
+    // Entity position to dense index
+    std::vector<std::uint32_t> m_sparse;
+
+    std::byte* insertUntyped (EntityId id);
+    void onInsert (EntityId id);
+    void removeIndex (std::uint32_t index);
+};
+} // namespace phenyl::core::detail
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace phenyl::core {
+// Memory used by a component, either as a column of one archetype or summed over the whole world
+struct ComponentMemoryStats {
+    std::string_view name;
+    std::size_t count = 0;
+    // Bytes taken up by the components and their change ticks
+    std::size_t usedBytes = 0;
+    // Bytes allocated, including slack kept for growth
+    std::size_t reservedBytes = 0;
+};
+
+struct ArchetypeMemoryStats {
+    std::size_t entities = 0;
+    // Including entity ids
+    std::size_t usedBytes = 0;
+    std::size_t reservedBytes = 0;
+    // Cached transitions to other archetypes
+    std::size_t edges = 0;
+    std::vector<ComponentMemoryStats> components;
+};
+
+struct WorldMemoryStats {
+    std::vector<ArchetypeMemoryStats> archetypes;
+    // Per component type, over every archetype and sparse set
+    std::vector<ComponentMemoryStats> components;
+    std::size_t emptyArchetypes = 0;
+    std::size_t edges = 0;
+
+    // Entity id list, entity locations and relationships
+    std::size_t entityUsedBytes = 0;
+    std::size_t entityReservedBytes = 0;
+
+    std::size_t usedBytes = 0;
+    std::size_t reservedBytes = 0;
+};
+} // namespace phenyl::core
@@ -3,30 +3,80 @@
 #include "archetype.h"
 #include "archetype_view.h"
 #include "children_view.h"
+#include "detail/change_tick.h"
+#include "detail/relationships.h"
+#include "detail/sparse_set.h"
 
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <memory>
-#include <unordered_set>
+#include <optional>
+#include <span>
 #include <vector>
 
 namespace phenyl::core {
 namespace detail {
     class QueryKey {
     public:
-        QueryKey (ArchetypeKey archKey, std::vector<meta::TypeIndex> interfaces);
+        QueryKey (ArchetypeKey archKey, std::vector<meta::TypeIndex> interfaces, std::vector<meta::TypeIndex> sparse);
 
+        // Sparse set components are not considered
         bool isSatisfied (const Archetype* archetype);
 
+        [[nodiscard]] const std::vector<meta::TypeIndex>& sparse () const noexcept {
+            return m_sparse;
+        }
+
         bool operator== (const QueryKey& other) const;
 
     private:
         ArchetypeKey m_archKey;
         std::vector<meta::TypeIndex> m_interfaces;
+        std::vector<meta::TypeIndex> m_sparse;
+    };
+
+    struct ChangeFilter {
+        meta::TypeIndex type;
+        bool added;
+        SparseComponentSet* sparse = nullptr;
+    };
+
+    // Matches the rows of an archetype whose filtered components are newer than lastRun
+    class ChangeFilterView {
+    public:
+        ChangeFilterView (const Archetype& archetype, std::span<const ChangeFilter> filters, std::uint32_t lastRun);
+
+        [[nodiscard]] bool matches (std::size_t pos) const noexcept {
+            return std::ranges::all_of(m_ticks, [&] (const std::uint32_t* ticks) { return TickNewer(ticks[pos], m_lastRun); });
+        }
+
+        [[nodiscard]] bool matchesAny (std::size_t pos) const noexcept {
+            return std::ranges::any_of(m_ticks, [&] (const std::uint32_t* ticks) { return TickNewer(ticks[pos], m_lastRun); });
+        }
+
+        // Checks a single row, including filters on sparse set components
+        static bool MatchesRow (const Archetype& archetype, std::size_t pos, EntityId id,
+            std::span<const ChangeFilter> filters, std::uint32_t lastRun);
+
+    private:
+        std::vector<const std::uint32_t*> m_ticks;
+        std::uint32_t m_lastRun;
     };
 } // namespace detail
 
+// Query filter matching entities whose T was inserted since the query last ran
+template <typename T>
+struct Added {};
+
+// Query filter matching entities whose T was inserted or mutably accessed since the query last ran
+template <typename T>
+struct Changed {};
+
+// Archetypes matching a query key, in creation order
 class QueryArchetypes {
 public:
-    explicit QueryArchetypes (World& world, detail::QueryKey key);
+    explicit QueryArchetypes (World& world, detail::QueryKey key, std::size_t id);
 
     class Iterator {
     public:
@@ -47,9 +97,12 @@ public:
         bool operator== (const Iterator&) const noexcept;
 
     private:
-        std::unordered_set<Archetype*>::const_iterator m_it;
+        std::vector<Archetype*>::const_iterator m_it;
+        std::vector<Archetype*>::const_iterator m_end;
 
-        Iterator (std::unordered_set<Archetype*>::const_iterator it);
+        // Empty archetypes are skipped
+        Iterator (std::vector<Archetype*>::const_iterator it, std::vector<Archetype*>::const_iterator end);
+        void skipEmpty ();
         friend QueryArchetypes;
     };
 
@@ -60,14 +113,18 @@ public:
         return m_key;
     }
 
+    [[nodiscard]] std::size_t id () const noexcept {
+        return m_id;
+    }
+
     void onNewArchetype (Archetype* archetype);
 
     iterator begin () {
-        return iterator{m_archetypes.begin()};
+        return iterator{m_archetypes.begin(), m_archetypes.end()};
     }
 
     iterator end () {
-        return iterator{m_archetypes.end()};
+        return iterator{m_archetypes.end(), m_archetypes.end()};
     }
 
     const_iterator begin () const {
@@ -75,7 +132,7 @@ public:
     }
 
     const_iterator cbegin () const {
-        return const_iterator{m_archetypes.begin()};
+        return const_iterator{m_archetypes.begin(), m_archetypes.end()};
     }
 
     const_iterator end () const {
@@ -83,20 +140,33 @@ public:
     }
 
     const_iterator cend () const {
-        return const_iterator{m_archetypes.end()};
+        return const_iterator{m_archetypes.end(), m_archetypes.end()};
     }
 
-    bool contains (Archetype* archetype) const noexcept {
-        return m_archetypes.contains(archetype);
+    bool contains (const Archetype* archetype) const noexcept {
+        return archetype && archetype->inQuery(m_id);
     }
 
     void lock ();
     void unlock ();
 
+    [[nodiscard]] std::uint32_t changeTick () const noexcept;
+    // Returns the current change tick of the world and moves on to the next one
+    std::uint32_t advanceChangeTick ();
+
+    // Flattened entity hierarchy of the world, with parents before children. Must be called while locked
+    const std::vector<detail::HierarchyEntry>& hierarchy ();
+    // Index of the entity in hierarchy()
+    [[nodiscard]] std::uint32_t hierarchyIndex (EntityId id) const;
+
+    // Runs task(i) for i in [0, numTasks) on the world's thread pool. Must be called while locked
+    void parallelFor (std::size_t numTasks, const std::function<void(std::size_t)>& task);
+
 private:
     World& m_world;
     detail::QueryKey m_key;
-    std::unordered_set<Archetype*> m_archetypes;
+    std::size_t m_id;
+    std::vector<Archetype*> m_archetypes;
 };
 
 template <typename F, typename... Args> concept Query2Callback = std::invocable<F, std::remove_reference_t<Args>&...>;
@@ -112,6 +182,8 @@ template <typename F, typename... Args> concept Query2BundleCallback = std::invo
 template <typename... Args>
 class Query {
 public:
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 256;
+
     Query () : m_archetypes{nullptr} {}
 
     explicit operator bool () const noexcept {
@@ -121,23 +193,112 @@ public:
     void each (const Query2Callback<Args...> auto& fn) const {
         PHENYL_DASSERT(*this);
         m_archetypes->lock();
-        for (auto& archetype : *m_archetypes) {
-            for (auto comps : ArchetypeView<Args...>{archetype, m_world}) {
-                fn(std::get<std::remove_reference_t<Args>&>(comps)...);
+        auto lastRun = lastRunTick();
+        if (!m_sparse.empty()) {
+            auto& driver = sparseDriver();
+            sparseRows(driver, 0, driver.size(), lastRun, [&] (Archetype& archetype, std::size_t pos, EntityId id) {
+                std::apply(fn, rowComponents(archetype, pos, id));
+            });
+        } else {
+            for (auto& archetype : *m_archetypes) {
+                ArchetypeView<Args...> view{archetype, m_world};
+                if (m_filters.empty()) {
+                    for (auto comps : view) {
+                        fn(std::get<std::remove_reference_t<Args>&>(comps)...);
+                    }
+                } else {
+                    filteredRows(archetype, 0, archetype.size(), lastRun, [&] (std::size_t pos) {
+                        auto comps = view.begin()[static_cast<std::ptrdiff_t>(pos)];
+                        fn(std::get<std::remove_reference_t<Args>&>(comps)...);
+                    });
+                }
             }
         }
+        finishFilters();
         m_archetypes->unlock();
     }
 
     void each (const Query2BundleCallback<Args...> auto& fn) const {
         PHENYL_DASSERT(*this);
         m_archetypes->lock();
-        for (auto& archetype : *m_archetypes) {
-            ArchetypeView<Args...> view{archetype, m_world};
-            for (const auto& bundle : view.bundles()) {
-                fn(bundle);
+        auto lastRun = lastRunTick();
+        if (!m_sparse.empty()) {
+            auto& driver = sparseDriver();
+            sparseRows(driver, 0, driver.size(), lastRun, [&] (Archetype& archetype, std::size_t pos, EntityId id) {
+                fn(Bundle<Args...>{Entity{id, m_world}, rowComponents(archetype, pos, id)});
+            });
+        } else {
+            for (auto& archetype : *m_archetypes) {
+                ArchetypeView<Args...> view{archetype, m_world};
+                if (m_filters.empty()) {
+                    for (const auto& bundle : view.bundles()) {
+                        fn(bundle);
+                    }
+                } else {
+                    filteredRows(archetype, 0, archetype.size(), lastRun,
+                        [&] (std::size_t pos) { fn(view.bundle(pos)); });
+                }
             }
         }
+        finishFilters();
+        m_archetypes->unlock();
+    }
+
+    // Parallel each(): the rows of every matching archetype are split into chunks of at most chunkSize and run on the
+    // world's thread pool. Callbacks must only touch the components they are passed; structural changes (insert,
+    // erase, create, remove etc.) are deferred until every chunk has finished.
+    void parEach (const Query2Callback<Args...> auto& fn, std::size_t chunkSize = DEFAULT_CHUNK_SIZE) const {
+        PHENYL_DASSERT(*this);
+        m_archetypes->lock();
+        auto lastRun = lastRunTick();
+        if (!m_sparse.empty()) {
+            parSparseRows(chunkSize, lastRun, [&] (Archetype& archetype, std::size_t pos, EntityId id) {
+                std::apply(fn, rowComponents(archetype, pos, id));
+            });
+        } else {
+            parChunks(chunkSize, [&] (Archetype& archetype, std::size_t start, std::size_t end) {
+                ArchetypeView<Args...> view{archetype, m_world};
+                if (m_filters.empty()) {
+                    auto endIt = view.begin() + static_cast<std::ptrdiff_t>(end);
+                    for (auto it = view.begin() + static_cast<std::ptrdiff_t>(start); it != endIt; ++it) {
+                        auto comps = *it;
+                        fn(std::get<std::remove_reference_t<Args>&>(comps)...);
+                    }
+                } else {
+                    filteredRows(archetype, start, end, lastRun, [&] (std::size_t pos) {
+                        auto comps = view.begin()[static_cast<std::ptrdiff_t>(pos)];
+                        fn(std::get<std::remove_reference_t<Args>&>(comps)...);
+                    });
+                }
+            });
+        }
+        finishFilters();
+        m_archetypes->unlock();
+    }
+
+    void parEach (const Query2BundleCallback<Args...> auto& fn, std::size_t chunkSize = DEFAULT_CHUNK_SIZE) const {
+        PHENYL_DASSERT(*this);
+        m_archetypes->lock();
+        auto lastRun = lastRunTick();
+        if (!m_sparse.empty()) {
+            parSparseRows(chunkSize, lastRun, [&] (Archetype& archetype, std::size_t pos, EntityId id) {
+                fn(Bundle<Args...>{Entity{id, m_world}, rowComponents(archetype, pos, id)});
+            });
+        } else {
+            parChunks(chunkSize, [&] (Archetype& archetype, std::size_t start, std::size_t end) {
+                ArchetypeView<Args...> view{archetype, m_world};
+                if (m_filters.empty()) {
+                    auto bundles = view.bundles();
+                    auto endIt = bundles.begin() + static_cast<std::ptrdiff_t>(end);
+                    for (auto it = bundles.begin() + static_cast<std::ptrdiff_t>(start); it != endIt; ++it) {
+                        fn(*it);
+                    }
+                } else {
+                    filteredRows(archetype, start, end, lastRun, [&] (std::size_t pos) { fn(view.bundle(pos)); });
+                }
+            });
+        }
+        finishFilters();
         m_archetypes->unlock();
     }
 
@@ -157,8 +318,34 @@ public:
         }
     }
 
+    // Calls fn(i, bundle) with the bundle of the entity in row positions[i] of archetype, for each i, if the archetype
+    // matches the query. Rows share a single view of the archetype, so must not move while fn runs
+    void rows (Archetype& archetype, std::span<const std::size_t> positions, auto&& fn) const {
+        PHENYL_DASSERT(*this);
+        if (!m_archetypes->contains(&archetype)) {
+            return;
+        }
+
+        if (!m_sparse.empty()) {
+            for (std::size_t i = 0; i < positions.size(); i++) {
+                auto id = archetype.entityIds()[positions[i]];
+                if (inSparseSets(id)) {
+                    fn(i, Bundle<Args...>{Entity{id, m_world}, rowComponents(archetype, positions[i], id)});
+                }
+            }
+            return;
+        }
+
+        ArchetypeView<Args...> view{archetype, m_world};
+        for (std::size_t i = 0; i < positions.size(); i++) {
+            fn(i, view.bundle(positions[i]));
+        }
+    }
+
     void pairs (const Query2PairCallback<Args...> auto& fn) const {
         PHENYL_DASSERT(*this);
+        PHENYL_DASSERT_MSG(m_filters.empty(), "Change filters are not supported by pairs()");
+        PHENYL_DASSERT_MSG(m_sparse.empty(), "Sparse set components are not supported by pairs()");
 
         m_archetypes->lock();
         for (auto a1It = m_archetypes->begin(); a1It != m_archetypes->end(); ++a1It) {
@@ -173,10 +360,51 @@ public:
         m_archetypes->unlock();
     }
 
+    // Calls fn for each entity with the bundle of its parent, or null for root entities. Parents are visited before
+    // their children, and children of entities that do not match the query are skipped. With change filters only
+    // entities that match them, entered the query or were reparented since the last run are visited, along with all of
+    // their descendants
     void hierarchical (const QueryHierachicalCallback<Args...> auto& fn) const {
         PHENYL_DASSERT(*this);
+        PHENYL_DASSERT_MSG(m_filters.empty() || m_sparse.empty(),
+            "Change filters are not supported by hierarchical() with sparse set components");
         m_archetypes->lock();
-        hierarchicalIter(fn, Entity{EntityId{}, m_world}, nullptr);
+        auto lastRun = lastRunTick();
+
+        const auto& hierarchy = m_archetypes->hierarchy();
+        m_hierarchyFlags.assign(hierarchy.size(), m_filters.empty() ? HIERARCHY_DIRTY : 0);
+        m_hierarchyBundleIndices.resize(hierarchy.size());
+        m_hierarchyBundles.clear();
+        // Parent bundles are referenced by pointer, so must not be reallocated
+        m_hierarchyBundles.reserve(hierarchy.size());
+        if (!m_filters.empty()) {
+            markHierarchyChanges(lastRun);
+        }
+
+        // Entries only reference earlier entries, so a single pass sees every parent before its children
+        std::optional<ArchetypeView<Args...>> view;
+        Archetype* viewArchetype = nullptr;
+        for (std::uint32_t i = 0; i < hierarchy.size(); i++) {
+            auto [_, parent, parentTick] = hierarchy[i];
+            auto& flags = m_hierarchyFlags[i];
+            if (detail::TickNewer(parentTick, lastRun) || (parent != detail::HierarchyEntry::NoParent &&
+                    (m_hierarchyFlags[parent] & HIERARCHY_DIRTY))) {
+                flags |= HIERARCHY_DIRTY;
+            }
+
+            if (!(flags & HIERARCHY_DIRTY)) {
+                continue;
+            }
+
+            if (auto* bundle = resolveHierarchyRow(hierarchy, i, view, viewArchetype)) {
+                fn(parent != detail::HierarchyEntry::NoParent ?
+                       &m_hierarchyBundles[m_hierarchyBundleIndices[parent]] :
+                       nullptr,
+                    *bundle);
+            }
+        }
+
+        finishFilters();
         m_archetypes->unlock();
     }
 
@@ -184,11 +412,116 @@ private:
     std::shared_ptr<QueryArchetypes> m_archetypes;
     World* m_world;
 
-    explicit Query (std::shared_ptr<QueryArchetypes> archetypes, World* world) :
+    std::vector<detail::ChangeFilter> m_filters;
+    // Change tick of the end of the last filtered iteration
+    mutable std::uint32_t m_lastRun = 0;
+
+    // Sparse set components of the query, including filtered ones. If any, iteration is driven by the smallest set
+    std::vector<detail::SparseComponentSet*> m_sparse;
+    // Sparse set of each argument, or null if stored in archetypes
+    std::array<detail::SparseComponentSet*, sizeof...(Args)> m_sparseArgs{};
+
+    // Row is visited by hierarchical(), along with its descendants
+    static constexpr std::uint8_t HIERARCHY_DIRTY = 1 << 0;
+    // Row has been looked up, and has a bundle if HIERARCHY_MATCHED is also set
+    static constexpr std::uint8_t HIERARCHY_RESOLVED = 1 << 1;
+    static constexpr std::uint8_t HIERARCHY_MATCHED = 1 << 2;
+
+    // Scratch space for hierarchical(), indexed the same as the world hierarchy except for the bundles themselves
+    mutable std::vector<std::uint8_t> m_hierarchyFlags;
+    mutable std::vector<std::uint32_t> m_hierarchyBundleIndices;
+    mutable std::vector<Bundle<Args...>> m_hierarchyBundles;
+
+    explicit Query (std::shared_ptr<QueryArchetypes> archetypes, World* world,
+        std::vector<detail::ChangeFilter> filters = {}, std::vector<detail::SparseComponentSet*> sparse = {}) :
         m_archetypes{std::move(archetypes)},
-        m_world{world} {}
+        m_world{world},
+        m_filters{std::move(filters)},
+        m_sparse{std::move(sparse)},
+        m_sparseArgs{findSparse<Args>()...} {}
     friend class World;
 
+    template <typename T>
+    detail::SparseComponentSet* findSparse () const {
+        auto it = std::ranges::find(m_sparse, meta::TypeIndex::Get<T>(), &detail::SparseComponentSet::type);
+        return it != m_sparse.end() ? *it : nullptr;
+    }
+
+    detail::SparseComponentSet& sparseDriver () const {
+        return **std::ranges::min_element(m_sparse, {}, &detail::SparseComponentSet::size);
+    }
+
+    // Calls rowFn(archetype, pos, id) for each entity in [start, end) of driver that matches the query
+    void sparseRows (const detail::SparseComponentSet& driver, std::size_t start, std::size_t end, std::uint32_t lastRun,
+        const auto& rowFn) const {
+        for (auto i = start; i < end; i++) {
+            auto id = driver.id(i);
+            auto entry = Entity{id, m_world}.entry();
+            if (!m_archetypes->contains(entry.archetype) || !inSparseSets(id)) {
+                continue;
+            }
+
+            if (!m_filters.empty() &&
+                !detail::ChangeFilterView::MatchesRow(*entry.archetype, entry.pos, id, m_filters, lastRun)) {
+                continue;
+            }
+
+            rowFn(*entry.archetype, entry.pos, id);
+        }
+    }
+
+    void parSparseRows (std::size_t chunkSize, std::uint32_t lastRun, const auto& rowFn) const {
+        PHENYL_DASSERT(chunkSize);
+        auto& driver = sparseDriver();
+        m_archetypes->parallelFor((driver.size() + chunkSize - 1) / chunkSize, [&] (std::size_t i) {
+            sparseRows(driver, i * chunkSize, std::min((i + 1) * chunkSize, driver.size()), lastRun, rowFn);
+        });
+    }
+
+    [[nodiscard]] bool inSparseSets (EntityId id) const noexcept {
+        return std::ranges::all_of(m_sparse, [&] (const detail::SparseComponentSet* set) { return set->contains(id); });
+    }
+
+    std::tuple<Args&...> rowComponents (Archetype& archetype, std::size_t pos, EntityId id) const {
+        return rowComponents(archetype, pos, id, std::index_sequence_for<Args...>{});
+    }
+
+    template <std::size_t... Is>
+    std::tuple<Args&...> rowComponents (Archetype& archetype, std::size_t pos, EntityId id,
+        std::index_sequence<Is...>) const {
+        return {rowComponent<Args>(m_sparseArgs[Is], archetype, pos, id)...};
+    }
+
+    template <typename T>
+    static std::remove_reference_t<T>& rowComponent (detail::SparseComponentSet* set, Archetype& archetype,
+        std::size_t pos, EntityId id) {
+        using U = std::remove_reference_t<T>;
+        return set ? *set->template tryGet<U>(id) : archetype.template get<U>(pos);
+    }
+
+    void filteredRows (const Archetype& archetype, std::size_t start, std::size_t end, std::uint32_t lastRun,
+        const auto& rowFn) const {
+        detail::ChangeFilterView filter{archetype, m_filters, lastRun};
+        for (auto pos = start; pos < end; pos++) {
+            if (filter.matches(pos)) {
+                rowFn(pos);
+            }
+        }
+    }
+
+    // Last run tick, brought forward if older than any stored tick so that ticks past the wraparound still compare
+    // as newer
+    [[nodiscard]] std::uint32_t lastRunTick () const noexcept {
+        return detail::ClampTick(m_lastRun, m_archetypes->changeTick(), detail::StaleTickAge);
+    }
+
+    void finishFilters () const {
+        if (!m_filters.empty()) {
+            // Changes made during this iteration are not reported on the next one
+            m_lastRun = m_archetypes->advanceChangeTick();
+        }
+    }
+
     void pairsIter (const Query2PairCallback<Args...> auto& fn, ArchetypeView<Args...>& view) const {
         // Iterate though pairs within archetype
         auto bundles = view.bundles();
@@ -213,17 +546,85 @@ private:
         }
     }
 
-    void hierarchicalIter (const QueryHierachicalCallback<Args...> auto& fn, Entity parent,
-        const Bundle<Args...>* parentBundle) const {
-        for (auto child : parent.children()) {
-            auto childBundle = entityBundle(child);
-            if (!childBundle) {
-                continue;
+    // Marks the rows that match the change filters or entered the query since the last run as dirty
+    void markHierarchyChanges (std::uint32_t lastRun) const {
+        std::vector<detail::ChangeFilter> addedFilters{detail::ChangeFilter{meta::TypeIndex::Get<Args>(), true}...};
+        for (auto& archetype : *m_archetypes) {
+            detail::ChangeFilterView changed{archetype, m_filters, lastRun};
+            detail::ChangeFilterView added{archetype, addedFilters, lastRun};
+            auto ids = archetype.entityIds();
+            for (std::size_t pos = 0; pos < ids.size(); pos++) {
+                if (!changed.matches(pos) && !added.matchesAny(pos)) {
+                    continue;
+                }
+
+                auto index = m_archetypes->hierarchyIndex(ids[pos]);
+                PHENYL_DASSERT(index < m_hierarchyFlags.size());
+                m_hierarchyFlags[index] |= HIERARCHY_DIRTY;
             }
+        }
+    }
+
+    // Looks up the bundle of a hierarchy row, or null if it or any of its ancestors do not match the query. Clean rows
+    // are only looked up as parents of dirty rows, and are not marked as changed
+    const Bundle<Args...>* resolveHierarchyRow (const std::vector<detail::HierarchyEntry>& hierarchy, std::uint32_t index,
+        std::optional<ArchetypeView<Args...>>& view, Archetype*& viewArchetype) const {
+        auto& flags = m_hierarchyFlags[index];
+        if (flags & HIERARCHY_RESOLVED) {
+            return flags & HIERARCHY_MATCHED ? &m_hierarchyBundles[m_hierarchyBundleIndices[index]] : nullptr;
+        }
+        flags |= HIERARCHY_RESOLVED;
+
+        auto [id, parent, _] = hierarchy[index];
+        if (parent != detail::HierarchyEntry::NoParent &&
+            !resolveHierarchyRow(hierarchy, parent, view, viewArchetype)) {
+            return nullptr;
+        }
+
+        if (!id) {
+            return nullptr;
+        }
 
-            fn(parentBundle, *childBundle);
-            hierarchicalIter(fn, child, &*childBundle);
+        Entity entity{id, m_world};
+        auto entry = entity.entry();
+        if (!m_archetypes->contains(entry.archetype)) {
+            return nullptr;
         }
+
+        if (!m_sparse.empty()) {
+            if (!inSparseSets(id)) {
+                return nullptr;
+            }
+            m_hierarchyBundles.emplace_back(entity, rowComponents(*entry.archetype, entry.pos, id));
+        } else {
+            // Siblings usually share an archetype, so the column lookups of the last one are reused
+            if (viewArchetype != entry.archetype) {
+                viewArchetype = entry.archetype;
+                view.emplace(*viewArchetype, m_world);
+            }
+            m_hierarchyBundles.emplace_back(
+                flags & HIERARCHY_DIRTY ? view->bundle(entry.pos) : view->readBundle(entry.pos));
+        }
+
+        flags |= HIERARCHY_MATCHED;
+        m_hierarchyBundleIndices[index] = static_cast<std::uint32_t>(m_hierarchyBundles.size() - 1);
+        return &m_hierarchyBundles.back();
+    }
+
+    void parChunks (std::size_t chunkSize, const auto& chunkFn) const {
+        PHENYL_DASSERT(chunkSize);
+
+        std::vector<std::tuple<Archetype*, std::size_t, std::size_t>> chunks;
+        for (auto& archetype : *m_archetypes) {
+            for (std::size_t start = 0; start < archetype.size(); start += chunkSize) {
+                chunks.emplace_back(&archetype, start, std::min(start + chunkSize, archetype.size()));
+            }
+        }
+
+        m_archetypes->parallelFor(chunks.size(), [&] (std::size_t i) {
+            auto [archetype, start, end] = chunks[i];
+            chunkFn(*archetype, start, end);
+        });
     }
 
     std::optional<Bundle<Args...>> entityBundle (Entity entity) const {
@@ -233,7 +634,58 @@ private:
             return std::nullopt;
         }
 
+        if (!m_sparse.empty()) {
+            if (!inSparseSets(entity.id())) {
+                return std::nullopt;
+            }
+
+            return Bundle<Args...>{entity, rowComponents(*archetype, entry.pos, entity.id())};
+        }
+
         return ArchetypeView<Args...>{*archetype, m_world}.bundle(entry.pos);
     }
 };
+
+namespace detail {
+    template <typename T>
+    struct QueryArg {
+        using Type = T;
+        using Components = std::tuple<T>;
+
+        static void AddFilter (std::vector<ChangeFilter>&) {}
+    };
+
+    template <typename T>
+    struct QueryArg<Added<T>> {
+        using Type = T;
+        using Components = std::tuple<>;
+
+        static void AddFilter (std::vector<ChangeFilter>& filters) {
+            filters.emplace_back(meta::TypeIndex::Get<T>(), true);
+        }
+    };
+
+    template <typename T>
+    struct QueryArg<Changed<T>> {
+        using Type = T;
+        using Components = std::tuple<>;
+
+        static void AddFilter (std::vector<ChangeFilter>& filters) {
+            filters.emplace_back(meta::TypeIndex::Get<T>(), false);
+        }
+    };
+
+    template <typename Tuple>
+    struct QueryFromTuple;
+
+    template <typename... Args>
+    struct QueryFromTuple<std::tuple<Args...>> {
+        using Type = Query<Args...>;
+    };
+
+    // Query over Args with any filters removed
+    template <typename... Args>
+    using FilteredQuery = typename QueryFromTuple<decltype(std::tuple_cat(
+        std::declval<typename QueryArg<Args>::Components>()...))>::Type;
+} // namespace detail
 } // namespace phenyl::core
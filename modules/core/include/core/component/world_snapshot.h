@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/entity.h"
+#include "core/entity_id.h"
+#include "detail/component_vector.h"
+#include "detail/entity_id_list.h"
+#include "detail/relationships.h"
+#include "detail/sparse_set.h"
+
+#include <memory>
+#include <vector>
+
+namespace phenyl::core {
+class Archetype;
+class World;
+
+// Copy of the entities, components and relationships of a world, taken by World::snapshot() and put back with
+// World::restore(). Taking another snapshot into the same object reuses its allocations, and snapshots taken against
+// a base share the columns and entity tables that have not changed since it
+class WorldSnapshot {
+public:
+    WorldSnapshot () = default;
+
+    WorldSnapshot (const WorldSnapshot&) = delete;
+    WorldSnapshot (WorldSnapshot&&) = default;
+
+    WorldSnapshot& operator= (const WorldSnapshot&) = delete;
+    WorldSnapshot& operator= (WorldSnapshot&&) = default;
+
+    [[nodiscard]] bool empty () const noexcept {
+        return !m_world;
+    }
+
+    [[nodiscard]] std::size_t numEntities () const noexcept {
+        return m_entities ? m_entities->idList.size() : 0;
+    }
+
+    // Bytes allocated for the snapshot, with storage shared with other snapshots split evenly between them
+    [[nodiscard]] std::size_t memoryUsage () const noexcept;
+
+private:
+    struct Entities {
+        std::vector<detail::EntityEntry> entries;
+        detail::EntityIdList idList{0};
+        detail::RelationshipManager relationships{0};
+    };
+
+    struct ArchetypeState {
+        std::vector<EntityId> ids;
+        // In the same order as the archetype's components
+        std::vector<std::shared_ptr<UntypedComponentVector>> columns;
+    };
+
+    // World the snapshot was taken of, as archetypes and sparse sets are matched up by index
+    const World* m_world = nullptr;
+    // Change tick the snapshot was taken at, which rows changed since have a later tick than
+    std::uint32_t m_tick = 0;
+
+    // Indexed the same as the world's archetypes. Archetypes made after the snapshot are empty once restored
+    std::vector<ArchetypeState> m_archetypes;
+    std::vector<std::pair<meta::TypeIndex, std::unique_ptr<detail::SparseComponentSet>>> m_sparseSets;
+    std::shared_ptr<Entities> m_entities;
+
+    friend World;
+};
+} // namespace phenyl::core
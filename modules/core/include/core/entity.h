@@ -1,6 +1,12 @@
 #pragma once
 
 #include "core/component/archetype.h"
+#include "core/component/command_buffer.h"
+#include "core/component/detail/sparse_set.h"
+
+#include <array>
+#include <span>
+#include <utility>
 
 namespace phenyl::core {
 class Archetype;
@@ -9,7 +15,12 @@ namespace detail {
     struct EntityEntry {
         Archetype* archetype;
         std::size_t pos;
+
+        bool operator== (const EntityEntry& other) const = default;
     };
+
+    template <typename Signal>
+    class SignalHandlerVector;
 } // namespace detail
 class World;
 class ChildrenView;
@@ -31,7 +42,11 @@ public:
             return nullptr;
         }
 
-        auto& e = entry();
+        if (auto* set = sparseSet(meta::TypeIndex::Get<T>())) {
+            return set->template tryGet<T>(id());
+        }
+
+        auto e = entry();
         return e.archetype->tryGet<T>(e.pos);
     }
 
@@ -42,13 +57,17 @@ public:
             return nullptr;
         }
 
-        auto& e = entry();
-        return e.archetype->tryGet<T>(e.pos);
+        if (const auto* set = sparseSet(meta::TypeIndex::Get<T>())) {
+            return set->template tryGet<T>(id());
+        }
+
+        auto e = entry();
+        return std::as_const(*e.archetype).tryGet<T>(e.pos);
     }
 
     template <typename T>
     void insert (T&& comp) {
-        emplace<T>(std::forward<T>(comp));
+        emplace<std::remove_cvref_t<T>>(std::forward<T>(comp));
     }
 
     template <typename T, typename... Args>
@@ -58,15 +77,19 @@ public:
             return;
         }
 
-        auto& e = entry();
-        if (e.archetype->has<T>()) {
+        auto* set = sparseSet(meta::TypeIndex::Get<T>());
+
+        // Entities created while deferred have no archetype until deferEnd()
+        auto e = entry();
+        if (set ? set->contains(id()) : e.archetype && e.archetype->has<T>()) {
             PHENYL_LOGE(LOGGER, "Attempted to add component to entity {} which already has it", id().value());
             return;
         }
 
         if (shouldDefer()) {
-            T comp{std::forward<Args>(args)...};
-            deferInsert(meta::TypeIndex::Get<T>(), reinterpret_cast<std::byte*>(&comp));
+            commands().template emplace<T>(id(), std::forward<Args>(args)...);
+        } else if (set) {
+            set->template emplace<T>(id(), std::forward<Args>(args)...);
         } else {
             e.archetype->addComponent<T>(e.pos, std::forward<Args>(args)...);
         }
@@ -80,13 +103,57 @@ public:
         }
 
         if (shouldDefer()) {
-            deferErase(meta::TypeIndex::Get<T>());
+            commands().template erase<T>(id());
+        } else if (auto* set = sparseSet(meta::TypeIndex::Get<T>())) {
+            set->erase(id());
         } else {
-            auto& e = entry();
+            auto e = entry();
             e.archetype->removeComponent<T>(e.pos);
         }
     }
 
+    // Inserts all of the components with a single archetype move, raising OnInsert for each once they are all in place
+    template <typename... Ts>
+    void insertAll (Ts&&... comps) {
+        PHENYL_DASSERT_MSG((detail::ArchetypeKey::Make<std::remove_cvref_t<Ts>...>().unique()),
+            "Duplicate component types passed to insertAll()");
+        if (!exists()) {
+            PHENYL_LOGE(LOGGER, "Attempted to add components to non-existent entity {}", id().value());
+            return;
+        }
+
+        if (shouldDefer()) {
+            commands().insertAll(id(), std::forward<Ts>(comps)...);
+            return;
+        }
+
+        // Sparse set and already present components go through insert() for its usual handling
+        if ((sparseSet(meta::TypeIndex::Get<Ts>()) || ...) ||
+            (entry().archetype->template has<std::remove_cvref_t<Ts>>() || ...)) {
+            (insert(std::forward<Ts>(comps)), ...);
+            return;
+        }
+
+        auto e = entry();
+        e.archetype->addComponents(e.pos, std::forward<Ts>(comps)...);
+        raiseInserts(std::array{meta::TypeIndex::Get<Ts>()...});
+    }
+
+    // Erases all of the components with a single archetype move, after raising OnRemove for each
+    template <typename... Ts>
+    void eraseAll () {
+        if (!exists()) {
+            PHENYL_LOGE(LOGGER, "Attempted to erase components from non-existent entity {}", id().value());
+            return;
+        }
+
+        if (shouldDefer()) {
+            commands().template eraseAll<Ts...>(id());
+        } else {
+            eraseUntyped(std::array{meta::TypeIndex::Get<Ts>()...});
+        }
+    }
+
     template <typename T>
     bool has () const {
         if (!exists()) {
@@ -94,6 +161,10 @@ public:
             return false;
         }
 
+        if (const auto* set = sparseSet(meta::TypeIndex::Get<T>())) {
+            return set->contains(id());
+        }
+
         return entry().archetype->has<T>();
     }
 
@@ -102,10 +173,10 @@ public:
         raiseUntyped(meta::TypeIndex::Get<Signal>(), reinterpret_cast<std::byte*>(&signal));
     }
 
-    template <typename T>
-    void apply (std::function<void(T&)> applyFunc) {
+    template <typename T, std::invocable<T&> F>
+    void apply (F&& applyFunc) {
         if (shouldDefer()) {
-            deferApply([func = std::move(applyFunc)] (Entity entity) { entity.apply(std::move(func)); });
+            commands().template apply<T>(id(), std::forward<F>(applyFunc));
             return;
         }
 
@@ -138,17 +209,21 @@ private:
     EntityId m_id;
     World* m_world = nullptr;
 
-    [[nodiscard]] const detail::EntityEntry& entry () const;
+    [[nodiscard]] detail::EntityEntry entry () const;
+    [[nodiscard]] detail::SparseComponentSet* sparseSet (meta::TypeIndex compType) const noexcept;
     void raiseUntyped (meta::TypeIndex signalType, std::byte* ptr);
     bool shouldDefer ();
-    void deferInsert (meta::TypeIndex compType, std::byte* ptr);
-    void deferErase (meta::TypeIndex compType);
-    void deferApply (std::function<void(Entity)> applyFunc);
+    // Command buffer of the calling thread, for changes made while deferred
+    CommandBuffer& commands ();
+    void raiseInserts (std::span<const meta::TypeIndex> compTypes);
+    void eraseUntyped (std::span<const meta::TypeIndex> compTypes);
 
     friend World;
     template <typename... Args>
     friend class ArchetypeView;
     template <typename... Args>
     friend class Query;
+    template <typename Signal>
+    friend class detail::SignalHandlerVector;
 };
 } // namespace phenyl::core
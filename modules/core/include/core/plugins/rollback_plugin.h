@@ -0,0 +1,24 @@
+#pragma once
+
+#include "core/plugin.h"
+#include "core/rollback.h"
+
+#include <memory>
+
+namespace phenyl::core {
+// Keeps the state after each of the last few fixed timesteps in the Rollback resource
+class RollbackPlugin : public IPlugin {
+public:
+    static constexpr std::size_t DEFAULT_FRAMES = 16;
+
+    explicit RollbackPlugin (std::size_t frames = DEFAULT_FRAMES);
+    ~RollbackPlugin () override;
+
+    [[nodiscard]] std::string_view getName () const noexcept override;
+    void init (PhenylRuntime& runtime) override;
+
+private:
+    std::size_t m_frames;
+    std::unique_ptr<Rollback> m_rollback;
+};
+} // namespace phenyl::core
@@ -1,5 +1,6 @@
 #pragma once
 #include "assets/asset.h"
+#include "core/component/detail/archetype_key.h"
 #include "core/component/detail/prefab_factory.h"
 #include "entity.h"
 #include "util/type_index.h"
@@ -28,6 +29,8 @@ public:
     Prefab& operator= (Prefab&& other) noexcept;
 
     void instantiate (Entity entity) const;
+    // Creates count new root entities from the prefab, building each level of the hierarchy for all of them at once
+    std::vector<Entity> instantiateMany (std::size_t count) const;
 
     explicit operator bool () const noexcept {
         return m_id;
@@ -46,6 +49,14 @@ struct PrefabEntry {
     detail::PrefabFactories factories;
     std::vector<std::size_t> childEntries;
     std::size_t refCount;
+
+    detail::ArchetypeKey key;
+    // Components stored in sparse sets, split out of factories on first instantiation
+    detail::PrefabFactories sparseFactories;
+    // Filled in on first instantiation. Archetype of a new entity made from this prefab
+    Archetype* archetype = nullptr;
+    // The whole hierarchy with parents before children, paired with the index of the parent in this list
+    std::vector<std::pair<const PrefabEntry*, std::size_t>> layout;
 };
 
 class PrefabManager : public std::enable_shared_from_this<PrefabManager> {
@@ -58,6 +69,7 @@ public:
     void incrementRefCount (std::size_t prefabId);
     void decrementRefCount (std::size_t prefabId);
     void instantiate (std::size_t prefabId, Entity entity);
+    std::vector<Entity> instantiateMany (std::size_t prefabId, std::size_t count);
 
     void defer ();
     void deferEnd ();
@@ -68,6 +80,8 @@ private:
     std::size_t m_nextPrefabId = 1;
     std::vector<std::pair<EntityId, std::size_t>> m_deferredInstantiations;
     bool m_deferring = false;
+
+    PrefabEntry& compile (std::size_t prefabId);
 };
 
 class PrefabBuilder {
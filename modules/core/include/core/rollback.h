@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core/component/world_snapshot.h"
+#include "iresource.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace phenyl::core {
+class PhenylRuntime;
+class RollbackPlugin;
+
+// Ring buffer of the world state after each of the most recent fixed timesteps. The world can be rewound to any stored
+// frame and the GlobalFixedTimestep stage run again from there. Each frame is snapshot against the one before it, so
+// columns and entity tables left untouched by a timestep are stored once. Resources are not rolled back
+class Rollback : public IResource {
+public:
+    Rollback (PhenylRuntime& runtime, std::size_t capacity);
+
+    // Number of fixed timesteps run, with frame() being the state after the latest of them
+    [[nodiscard]] std::uint64_t frame () const noexcept {
+        return m_frame;
+    }
+
+    // Number of frames kept
+    [[nodiscard]] std::size_t capacity () const noexcept {
+        return m_slots.size();
+    }
+
+    [[nodiscard]] bool canRewind (std::uint64_t frame) const noexcept;
+
+    // Restores the state after the given frame, discarding every later frame
+    void rewind (std::uint64_t frame);
+    // Rewinds to the given frame then runs GlobalFixedTimestep up to the current frame again. beforeStep is called with
+    // the number of each frame before it is simulated, so that the inputs used for it can be substituted
+    void resimulate (std::uint64_t frame, const std::function<void(std::uint64_t)>& beforeStep = {});
+
+    // Bytes used to store the frame, with storage shared with neighbouring frames split evenly between them
+    [[nodiscard]] std::size_t frameMemory (std::uint64_t frame) const;
+    // Bytes used to store every frame
+    [[nodiscard]] std::size_t memoryUsage () const noexcept;
+
+    [[nodiscard]] std::string_view getName () const noexcept override;
+
+private:
+    struct Slot {
+        std::uint64_t frame = 0;
+        WorldSnapshot snapshot;
+    };
+
+    PhenylRuntime& m_runtime;
+    // Indexed by frame modulo capacity
+    std::vector<Slot> m_slots;
+    std::uint64_t m_frame = 0;
+
+    // Stores the current state as the next frame
+    void record ();
+    [[nodiscard]] const Slot* slot (std::uint64_t frame) const noexcept;
+
+    friend RollbackPlugin;
+};
+} // namespace phenyl::core
@@ -6,10 +6,12 @@
 #include "plugin.h"
 #include "runtime/introspection.h"
 #include "runtime/stage.h"
+#include "runtime/stats.h"
 #include "runtime/system.h"
 #include "stages.h"
 
 #include <concepts>
+#include <functional>
 
 namespace phenyl::core {
 class IPlugin;
@@ -139,12 +141,13 @@ public:
         return *system;
     }
 
-    template <typename S, typename... Args>
+    // Filters (Added<T>/Changed<T>) limit each run to the subtrees of matching entities
+    template <typename S, typename... Filters, typename... Args>
     System<S>& addHierarchicalSystem (std::string systemName, void (*systemFunc)(Args...)) {
         auto* stage = getStage<S>();
         PHENYL_ASSERT(stage);
 
-        auto* system = makeHierarchicalSystem<S>(std::move(systemName), systemFunc);
+        auto* system = makeHierarchicalSystem<S, Filters...>(std::move(systemName), systemFunc);
         stage->addSystem(system);
 
         return *system;
@@ -169,6 +172,19 @@ public:
         before->runBefore(after);
     }
 
+    // Lets non-conflicting systems of the stage run concurrently. Only systems that have called declareAccess() are
+    // batched, the rest still run on their own
+    template <typename S>
+    void setStageParallel (bool parallel = true) {
+        auto* stage = getStage<S>();
+        PHENYL_ASSERT(stage);
+
+        stage->setParallel(parallel);
+    }
+
+    // Called after each run of the GlobalFixedTimestep stage, outside of any deferral
+    void addFixedTimestepCallback (std::function<void()> callback);
+
     void runPostInit ();
     void runFrameBegin ();
     void runFixedTimestep ();
@@ -179,6 +195,7 @@ public:
 
     const std::vector<ComponentInfo>& components () const noexcept;
     const std::vector<std::string>& plugins () const noexcept;
+    [[nodiscard]] WorldMemoryStats memoryStats () const;
 
 private:
     World m_world;
@@ -186,6 +203,7 @@ private:
     std::vector<ComponentInfo> m_componentInfos;
 
     ResourceManager m_resourceManager;
+    RuntimeStats m_stats;
 
     std::unordered_set<meta::TypeIndex> m_initPlugins;
     std::unordered_map<meta::TypeIndex, std::unique_ptr<IPlugin>> m_plugins;
@@ -193,6 +211,7 @@ private:
 
     std::unordered_map<std::string, std::unique_ptr<IRunnableSystem>> m_systems;
     std::unordered_map<meta::TypeIndex, std::unique_ptr<AbstractStage>> m_stages;
+    std::vector<std::function<void()>> m_fixedTimestepCallbacks;
 
     void registerPlugin (meta::TypeIndex typeIndex, IInitPlugin& plugin);
     void registerPlugin (meta::TypeIndex typeIndex, std::unique_ptr<IPlugin> plugin);
@@ -245,11 +264,12 @@ private:
         return ptr;
     }
 
-    template <typename S, typename... Args>
+    template <typename S, typename... Filters, typename... Args>
     System<S>* makeHierarchicalSystem (std::string systemName, void (*systemFunc)(Args...)) {
         PHENYL_DASSERT_MSG(!m_systems.contains(systemName), "Attempted to add duplicate system with name \"{}\"",
             systemName);
-        auto system = MakeHierachicalSystem<S>(std::move(systemName), systemFunc, world(), m_resourceManager);
+        auto system =
+            MakeHierachicalSystem<S, Filters...>(std::move(systemName), systemFunc, world(), m_resourceManager);
         auto* ptr = system.get();
         m_systems[ptr->getName()] = std::move(system);
 
@@ -28,14 +28,14 @@ public:
 
     template <std::derived_from<IResource> T>
     T* resourceMaybe () {
-        auto typeIndex = meta::TypeIndex::Get<T>();
-        return m_resources.contains(typeIndex) ? static_cast<T*>(m_resources[typeIndex]) : nullptr;
+        auto it = m_resources.find(meta::TypeIndex::Get<T>());
+        return it != m_resources.end() ? static_cast<T*>(it->second) : nullptr;
     }
 
     template <std::derived_from<IResource> T>
     const T* resourceMaybe () const {
-        auto typeIndex = meta::TypeIndex::Get<T>();
-        return m_resources.contains(typeIndex) ? static_cast<const T*>(m_resources[typeIndex]) : nullptr;
+        auto it = m_resources.find(meta::TypeIndex::Get<T>());
+        return it != m_resources.end() ? static_cast<const T*>(it->second) : nullptr;
     }
 
     template <std::derived_from<IResource> T, typename... Args>
@@ -50,6 +50,8 @@ public:
         registerResource(meta::TypeIndex::Get<T>(), resource);
     }
 
+    [[nodiscard]] std::string_view resourceName (meta::TypeIndex type) const noexcept;
+
 private:
     std::vector<std::unique_ptr<IResource>> m_ownedResources;
     std::unordered_map<meta::TypeIndex, IResource*> m_resources;
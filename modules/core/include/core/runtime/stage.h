@@ -4,6 +4,7 @@
 #include "util/type_index.h"
 
 #include <memory>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
@@ -25,20 +26,41 @@ public:
         return m_name;
     }
 
+    // Whether systems with declared access in the same batch may run on the world's thread pool. Off by default, in which
+    // case every system runs on its own with the world undeferred
+    void setParallel (bool parallel) noexcept {
+        m_parallel = parallel;
+    }
+
+    // Human readable description of which systems run concurrently and why the rest do not
+    [[nodiscard]] std::string scheduleDump () const;
+
 protected:
+    // Systems that may run concurrently. Exclusive batches contain a single system run with the world undeferred
+    struct SystemBatch {
+        std::vector<IRunnableSystem*> systems;
+        // Why each system could not be placed in an earlier batch
+        std::vector<std::string> reasons;
+        bool exclusive = false;
+    };
+
     std::string m_name;
     PhenylRuntime& m_runtime;
     std::vector<IRunnableSystem*> m_systems;
     std::vector<IRunnableSystem*> m_orderedSystems;
+    std::vector<SystemBatch> m_batches;
 
     std::vector<AbstractStage*> m_childStages;
     std::unordered_set<AbstractStage*> m_prevStages;
 
     bool m_updated = false;
+    bool m_parallel = false;
 
     void addSystemUntyped (IRunnableSystem* system);
     void orderSystems ();
     void orderStages ();
+    void scheduleSystems ();
+    void runBatch (SystemBatch& batch);
     void orderSystemsRecursive (IRunnableSystem* system, std::unordered_set<IRunnableSystem*>& visited,
         std::unordered_set<IRunnableSystem*>& visiting);
     void orderStagesRecursive (AbstractStage* stage, std::unordered_set<AbstractStage*>& visited,
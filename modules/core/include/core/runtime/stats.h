@@ -0,0 +1,17 @@
+#pragma once
+
+#include "core/iresource.h"
+
+#include <cstddef>
+
+namespace phenyl::core {
+// Counters describing the previous frame, updated at the start of each frame
+struct RuntimeStats : public IResource {
+    // Signals passed to handlers
+    std::size_t signalsDispatched = 0;
+
+    [[nodiscard]] std::string_view getName () const noexcept override {
+        return "phenyl::RuntimeStats";
+    }
+};
+} // namespace phenyl::core
@@ -7,9 +7,55 @@
 
 #include <concepts>
 #include <functional>
+#include <optional>
 #include <unordered_set>
 
 namespace phenyl::core {
+// Components and resources a system reads and writes, used by stages to run non-conflicting systems concurrently
+class SystemAccess {
+public:
+    struct Conflict {
+        meta::TypeIndex type;
+        bool isResource;
+    };
+
+    template <typename... Components>
+    SystemAccess& withComponents () {
+        (addAccess(m_components, meta::TypeIndex::Get<Components>(), !std::is_const_v<std::remove_reference_t<Components>>),
+            ...);
+        return *this;
+    }
+
+    template <typename... ResourceTypes>
+    SystemAccess& withResources () {
+        (addAccess(m_resources, meta::TypeIndex::Get<ResourceTypes>(),
+             !std::is_const_v<std::remove_reference_t<ResourceTypes>>),
+            ...);
+        return *this;
+    }
+
+    // Returns the first component or resource that one system writes and the other accesses, if any. Accesses to
+    // interfaces only conflict with their implementors once resolved with resolveInterfaces()
+    [[nodiscard]] std::optional<Conflict> conflict (const SystemAccess& other) const;
+
+    // Adds every access of other to this
+    SystemAccess& merge (const SystemAccess& other);
+
+    // Copy with every access to an interface also applied to each component declared to implement it
+    [[nodiscard]] SystemAccess resolveInterfaces (const World& world) const;
+
+    // Whether the component or resource type is written to, or std::nullopt if it is not accessed
+    [[nodiscard]] std::optional<bool> componentAccess (meta::TypeIndex type) const;
+    [[nodiscard]] std::optional<bool> resourceAccess (meta::TypeIndex type) const;
+
+private:
+    // Sorted (type, isWrite) pairs
+    std::vector<std::pair<meta::TypeIndex, bool>> m_components;
+    std::vector<std::pair<meta::TypeIndex, bool>> m_resources;
+
+    static void addAccess (std::vector<std::pair<meta::TypeIndex, bool>>& accesses, meta::TypeIndex type, bool write);
+};
+
 class IRunnableSystem {
 public:
     explicit IRunnableSystem (std::string name) : m_name{std::move(name)} {}
@@ -22,8 +68,15 @@ public:
 
     virtual void run (PhenylRuntime& runtime) = 0;
 
+    // Exclusive systems run on their own with the world undeferred
     virtual bool exclusive () const noexcept {
-        return false;
+        return m_exclusive;
+    }
+
+    // Every component/resource the system touches, or nullptr if not declared. Systems without declared access are run
+    // exclusively
+    virtual const SystemAccess* access () const noexcept {
+        return nullptr;
     }
 
     const std::unordered_set<IRunnableSystem*>& getPrecedingSystems () const {
@@ -33,6 +86,11 @@ public:
 protected:
     std::unordered_set<IRunnableSystem*> m_parentSystems;
     std::string m_name;
+    bool m_exclusive = false;
+
+    virtual void declareAccessUntyped (const SystemAccess& extra) {
+        PHENYL_ABORT("System \"{}\" cannot declare its access", m_name);
+    }
 };
 
 template <typename Stage>
@@ -52,25 +110,51 @@ public:
 
         return *this;
     }
+
+    // Never run this system concurrently with others
+    System<Stage>& runExclusive () {
+        this->m_exclusive = true;
+
+        return *this;
+    }
+
+    // Declares that the system touches nothing beyond its signature and extra, including through Entity, signals and
+    // outside state. Parallel stages only run systems with declared access alongside others, and apply their structural
+    // changes once the whole batch has run
+    System<Stage>& declareAccess (const SystemAccess& extra = {}) {
+        this->declareAccessUntyped(extra);
+
+        return *this;
+    }
 };
 
 template <typename Stage>
 class FunctionSystem : public System<Stage> {
 public:
-    explicit FunctionSystem (std::string name, std::function<void()> func) :
+    explicit FunctionSystem (std::string name, std::function<void()> func, SystemAccess access) :
         System<Stage>{std::move(name)},
-        m_func{std::move(func)} {}
+        m_func{std::move(func)},
+        m_access{std::move(access)} {}
 
     void run (PhenylRuntime& runtime) override {
         m_func();
     }
 
-    bool exclusive () const noexcept override {
-        return true;
+    const SystemAccess* access () const noexcept override {
+        return m_accessDeclared ? &m_access : nullptr;
+    }
+
+protected:
+    void declareAccessUntyped (const SystemAccess& extra) override {
+        m_access.merge(extra);
+        m_accessDeclared = true;
     }
 
 private:
     std::function<void()> m_func;
+    // Accesses of the system signature, only complete once declared
+    SystemAccess m_access;
+    bool m_accessDeclared = false;
 };
 
 template <typename Stage, typename T>
@@ -104,7 +188,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName,
         query.each([&] (Components&... components) { func(resources, components...); });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<Components...>().template withResources<ResourceTypes...>());
 }
 
 template <typename Stage, ComponentType... Components>
@@ -117,7 +202,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName, void (*func)(
         query.each([&] (Components&... components) { func(components...); });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<Components...>());
 }
 
 template <typename Stage, ResourceType... ResourceTypes, ComponentType... Components>
@@ -133,7 +219,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName,
         query.each([&] (const core::Bundle<Components...>& bundle) { func(resources, bundle); });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<Components...>().template withResources<ResourceTypes...>());
 }
 
 /*template <typename Stage, ComponentType ...Components> requires (sizeof...(Components) > 0 &&
@@ -165,7 +252,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName,
         });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<Components...>().template withResources<ResourceTypes...>());
 }
 
 template <typename Stage, ComponentType... Components>
@@ -183,7 +271,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName,
         });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<Components...>());
 }
 
 template <typename Stage, ComponentType T, ResourceType... ResourceTypes, ComponentType... Components>
@@ -198,7 +287,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName,
         query.each([&] (T& obj, Components&... components) { (obj.*func)(resources, components...); });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<T, Components...>().template withResources<ResourceTypes...>());
 }
 
 template <typename Stage, ComponentType T, ComponentType... Components>
@@ -209,7 +299,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName, void (T::*fun
         query.each([&] (T& obj, Components&... components) { (obj.*func)(components...); });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<T, Components...>());
 }
 
 template <typename Stage, ComponentType T, ResourceType... ResourceTypes, ComponentType... Components>
@@ -226,7 +317,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName,
         });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<T, Components...>().template withResources<ResourceTypes...>());
 }
 
 template <typename Stage, ComponentType T, ComponentType... Components>
@@ -240,7 +332,8 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName,
         });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<T, Components...>());
 }
 
 template <typename Stage, ResourceType... ResourceTypes>
@@ -252,28 +345,30 @@ std::unique_ptr<System<Stage>> MakeSystem (std::string systemName, void (*func)(
         func(Resources<ResourceTypes...>{resManager});
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withResources<ResourceTypes...>());
 }
 
-template <typename Stage, ComponentType... Components>
+template <typename Stage, typename... Filters, ComponentType... Components>
 requires (sizeof...(Components) > 0)
 std::unique_ptr<System<Stage>> MakeHierachicalSystem (std::string systemName,
     void (*func)(const Bundle<Components...>*, const Bundle<Components...>&), World& world,
     ResourceManager& resManager) {
-    auto query = world.query<std::remove_reference_t<Components>...>();
+    auto query = world.query<std::remove_reference_t<Components>..., Filters...>();
     std::function<void()> func1 = [query = std::move(query), func] () {
         query.hierarchical(func);
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<Components...>());
 }
 
-template <typename Stage, ResourceType... ResourceTypes, ComponentType... Components>
+template <typename Stage, typename... Filters, ResourceType... ResourceTypes, ComponentType... Components>
 requires (sizeof...(Components) > 0)
 std::unique_ptr<System<Stage>> MakeHierachicalSystem (std::string systemName,
     void (*func)(const Resources<ResourceTypes...>&, const Bundle<Components...>*, const Bundle<Components...>&),
     World& world, ResourceManager& resManager) {
-    auto query = world.query<std::remove_reference_t<Components>...>();
+    auto query = world.query<std::remove_reference_t<Components>..., Filters...>();
     std::function<void()> func1 = [query = std::move(query), func, &resManager] () {
         Resources<ResourceTypes...> resources{resManager};
         query.hierarchical([&] (const Bundle<Components...>* parentBundle, const Bundle<Components...>& childBundle) {
@@ -281,6 +376,7 @@ std::unique_ptr<System<Stage>> MakeHierachicalSystem (std::string systemName,
         });
     };
 
-    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1));
+    return std::make_unique<FunctionSystem<Stage>>(std::move(systemName), std::move(func1),
+        SystemAccess{}.withComponents<Components...>().template withResources<ResourceTypes...>());
 }
 } // namespace phenyl::core
@@ -2,15 +2,23 @@
 
 #include "component/archetype.h"
 #include "component/children_view.h"
+#include "component/command_buffer.h"
 #include "component/detail/component_instance.h"
 #include "component/detail/entity_id_list.h"
 #include "component/detail/relationships.h"
 #include "component/detail/signal_handler.h"
+#include "component/detail/sparse_set.h"
 #include "component/forward.h"
+#include "component/memory_stats.h"
 #include "component/query.h"
+#include "component/world_snapshot.h"
 #include "entity.h"
 #include "entity_id.h"
 #include "prefab.h"
+#include "util/thread_pool.h"
+
+#include <atomic>
+#include <mutex>
 
 namespace phenyl::core {
 class World : private detail::IArchetypeManager {
@@ -53,12 +61,17 @@ public:
     World& operator= (World&&) = default;
 
     template <typename T>
-    void addComponent (std::string name) {
+    void addComponent (std::string name, ComponentStorage storage = ComponentStorage::Archetype) {
         PHENYL_ASSERT_MSG(!m_components.contains(meta::TypeIndex::Get<T>()), "Attempted to add component \"{}\" twice",
             name);
 
         auto comp = std::make_unique<detail::Component<T>>(this, std::move(name));
         auto index = comp->type();
+        if (storage == ComponentStorage::SparseSet) {
+            m_sparseSets.emplace(index,
+                std::make_unique<detail::SparseComponentSet>(static_cast<detail::IArchetypeManager&>(*this),
+                    comp->makeVector()));
+        }
         m_components.emplace(index, std::move(comp));
     }
 
@@ -72,18 +85,70 @@ public:
 
         auto it = m_components.find(compType);
         PHENYL_ASSERT_MSG(it != m_components.end(), "Cannot declare interface of non-existent component");
+        PHENYL_ASSERT_MSG(!sparseSet(compType), "Cannot declare interface of sparse set component");
 
         it->second->declareInterface(interfaceType);
     }
 
     Entity create (EntityId parent = EntityId{});
+
+    // Creates count root entities each with a copy of components, constructing them directly in their final archetype
+    // and raising OnInsert once all have been built. While deferred, the ids are valid immediately but the entities
+    // are only built at the matching deferEnd()
+    template <typename... Components>
+    std::vector<Entity> spawnBatch (std::size_t count, Components... components) requires (sizeof...(Components) > 0)
+    {
+        auto lock = parallelLock();
+        std::vector<EntityId> ids(count);
+        reserveIds(ids);
+
+        std::vector<Entity> entities;
+        entities.reserve(count);
+        for (auto id : ids) {
+            entities.emplace_back(id, this);
+        }
+
+        if (m_deferCount) {
+            m_deferredSpawns.emplace_back(
+                [this, ids = std::move(ids), ... components = std::move(components)] () {
+                    spawnInto(ids, components...);
+                });
+        } else {
+            spawnInto(ids, components...);
+        }
+
+        return entities;
+    }
+
     void remove (EntityId id);
     void reparent (EntityId id, EntityId parent);
 
     void clear ();
 
+    // Copies every entity, component and relationship into snapshot, reusing its allocations if it was taken of this
+    // world before. Trivially copyable components are copied a column at a time with memcpy, so all components must
+    // be copy constructible. The world must not be deferred
+    void snapshot (WorldSnapshot& snapshot);
+    // As above, but sharing storage with base wherever nothing has changed since base was taken. Base must be a
+    // snapshot of this world and must not be snapshot itself
+    void snapshot (WorldSnapshot& snapshot, const WorldSnapshot& base);
+    [[nodiscard]] WorldSnapshot snapshot ();
+    // Puts the world back to how it was when the snapshot was taken, without raising any signals. Restored components
+    // keep their added ticks but are marked as changed, so Changed<T> queries see the restored values
+    void restore (const WorldSnapshot& snapshot);
+
+    // Bytes used and reserved by each archetype and component
+    [[nodiscard]] WorldMemoryStats memoryStats () const;
+    // Releases storage kept for growth, e.g. after loading a level. Archetypes left empty keep no storage, but are not
+    // destroyed as queries may still refer to them
+    void shrinkToFit ();
+
     [[nodiscard]] bool exists (EntityId id) const noexcept {
-        return m_idList.check(id);
+        // Reading the id list needs no lock, as it only changes outside of parallel regions
+        if (m_idList.check(id)) {
+            return true;
+        }
+        return m_parallelCount && id && id.pos() >= m_idList.maxIndex() && isPendingId(id);
     }
 
     Entity entity (EntityId id) noexcept;
@@ -91,10 +156,23 @@ public:
 
     [[nodiscard]] Entity parent (EntityId id) noexcept;
 
+    // Args may include Added<T> and Changed<T> filters, which restrict each() and parEach() to entities whose T has
+    // been inserted or mutably accessed since the previous iteration of the returned query
     template <typename... Args>
-    Query<Args...> query () {
-        std::array comps{meta::TypeIndex::Get<Args>()...};
-        return Query<Args...>{makeQueryArchetypes(makeQueryKey(comps)), this};
+    detail::FilteredQuery<Args...> query () {
+        std::array comps{meta::TypeIndex::Get<typename detail::QueryArg<Args>::Type>()...};
+        std::vector<detail::ChangeFilter> filters;
+        (detail::QueryArg<Args>::AddFilter(filters), ...);
+        for (auto& filter : filters) {
+            filter.sparse = sparseSet(filter.type);
+        }
+
+        auto archetypes = makeQueryArchetypes(makeQueryKey(comps));
+        std::vector<detail::SparseComponentSet*> sparse;
+        for (auto type : archetypes->getKey().sparse()) {
+            sparse.emplace_back(sparseSet(type));
+        }
+        return detail::FilteredQuery<Args...>{std::move(archetypes), this, std::move(filters), std::move(sparse)};
     }
 
     template <typename T>
@@ -117,38 +195,28 @@ public:
 
     template <typename Signal, typename... Args>
     void addHandler (std::function<void(const Signal&, const Bundle<Args...>& bundle)> handler) {
-        detail::SignalHandlerVector<Signal>* handlerVec;
-        auto vecIt = m_signalHandlerVectors.find(meta::TypeIndex::Get<Signal>());
-        if (vecIt != m_signalHandlerVectors.end()) {
-            handlerVec = static_cast<detail::SignalHandlerVector<Signal>*>(vecIt->second.get());
-        } else {
-            auto newVec = std::make_unique<detail::SignalHandlerVector<Signal>>(*this);
-            handlerVec = newVec.get();
-            m_signalHandlerVectors.emplace(meta::TypeIndex::Get<Signal>(), std::move(newVec));
-        }
-
-        handlerVec->addHandler(
-            std::make_unique<detail::SignalHandler2<Signal, Args...>>(query<Args...>(), std::move(handler)));
+        addSignalHandler<Signal, Args...>(std::move(handler));
     }
 
     template <typename Signal, typename... Args>
     void addHandler (std::invocable<const Signal&, const Bundle<Args...>&> auto&& fn) {
-        addHandler<Signal, Args...>(
-            std::function<void(const Signal&, const Bundle<Args...>&)>{std::forward<decltype(fn)>(fn)});
+        addSignalHandler<Signal, Args...>(std::forward<decltype(fn)>(fn));
     }
 
     template <typename Signal, typename... Args>
     void addHandler (std::function<void(const Signal&, std::remove_reference_t<Args>&... args)> handler) {
-        addHandler(std::function<void(const Signal&, const Bundle<Args...>&)>{
-          [handler = std::move(handler)] (const Signal& signal, const Bundle<Args...>& bundle) {
-              handler(signal, bundle.template get<Args>()...);
-          }});
+        addSignalHandler<Signal, Args...>(
+            [handler = std::move(handler)] (const Signal& signal, const Bundle<Args...>& bundle) {
+                handler(signal, bundle.template get<Args>()...);
+            });
     }
 
     template <typename Signal, typename... Args>
     void addHandler (std::invocable<const Signal&, std::remove_reference_t<Args>&...> auto&& fn) {
-        addHandler<Signal, Args...>(
-            std::function<void(const Signal&, std::remove_reference_t<Args>&...)>{std::forward<decltype(fn)>(fn)});
+        addSignalHandler<Signal, Args...>(
+            [fn = std::forward<decltype(fn)>(fn)] (const Signal& signal, const Bundle<Args...>& bundle) mutable {
+                fn(signal, bundle.template get<Args>()...);
+            });
     }
 
     template <typename T>
@@ -157,27 +225,57 @@ public:
     }
 
     std::string_view componentName (meta::TypeIndex type) const noexcept;
+    // Components declared to implement the interface
+    [[nodiscard]] std::vector<meta::TypeIndex> interfaceImplementors (meta::TypeIndex interface) const;
 
     void defer ();
     void deferEnd ();
     void deferSignals ();
     void deferSignalsEnd ();
 
+    // Command buffer of the calling thread, which may only be recorded into while deferred. Buffers are run at the
+    // outermost deferEnd(), in the order the commands would have been recorded in if every parallel task had run in
+    // turn on a single thread
+    CommandBuffer& commandBuffer ();
+
     PrefabBuilder buildPrefab ();
 
+    // Worker pool used for parallel queries and systems, created on first use
+    util::ThreadPool& threadPool ();
+
+    // Runs task(i) for i in [0, numTasks) on the thread pool. The world must be deferred, and structural changes made
+    // by the tasks are recorded under a lock until the matching deferEnd()
+    void runParallel (std::size_t numTasks, const std::function<void(std::size_t)>& task);
+
+    // Tick that inserted and mutably accessed components are currently stamped with
+    [[nodiscard]] std::uint32_t changeTick () const noexcept override {
+        return std::atomic_ref{m_changeTick}.load(std::memory_order_relaxed);
+    }
+
+    // Number of signals passed to handlers since the last call
+    std::size_t takeDispatchedSignals () noexcept;
+
+    // Returns the current change tick and moves on to the next one
+    std::uint32_t advanceChangeTick () noexcept {
+        return std::atomic_ref{m_changeTick}.fetch_add(1, std::memory_order_relaxed);
+    }
+
     iterator begin ();
     iterator end ();
 
 private:
     std::unordered_map<meta::TypeIndex, std::unique_ptr<detail::UntypedComponent>> m_components;
+    std::unordered_map<meta::TypeIndex, std::unique_ptr<detail::SparseComponentSet>> m_sparseSets;
 
     detail::EntityIdList m_idList;
     detail::RelationshipManager m_relationships;
 
     std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    std::unordered_map<detail::ArchetypeKey, Archetype*> m_archetypeIndex;
     EmptyArchetype* m_emptyArchetype;
     std::vector<detail::EntityEntry> m_entityEntries;
 
+    // Indexed by query id, expired entries are free ids
     std::vector<std::weak_ptr<QueryArchetypes>> m_queryArchetypes;
 
     std::unordered_map<meta::TypeIndex, std::unique_ptr<detail::IHandlerVector>> m_signalHandlerVectors;
@@ -185,19 +283,115 @@ private:
     std::shared_ptr<PrefabManager> m_prefabManager;
 
     std::vector<std::pair<EntityId, EntityId>> m_deferredCreations;
-    std::vector<std::pair<EntityId, std::function<void(Entity)>>> m_deferredApplys;
     std::vector<EntityId> m_deferredRemovals;
-
+    // Reparents involving entities created in a parallel region, applied once they exist
+    std::vector<std::pair<EntityId, EntityId>> m_deferredReparents;
+    // Rows of entities detached by a batched removal, waiting to be compacted
+    std::vector<std::pair<Archetype*, std::size_t>> m_removedRows;
+    std::vector<std::function<void()>> m_deferredSpawns;
+    // Indexed by thread pool worker index, with the first for threads outside the pool
+    std::vector<std::unique_ptr<CommandBuffer>> m_commandBuffers;
+
+    // Changed under the parallel lock, but read without it by parallel tasks, so only accessed atomically outside the
+    // lock
     std::uint32_t m_deferCount = 0;
     std::uint32_t m_removeDeferCount = 0;
     std::uint32_t m_signalDeferCount = 0;
+    std::size_t m_dispatchedSignals = 0;
+    // Starts above the initial last run of queries so that existing components are reported as added
+    mutable std::uint32_t m_changeTick = 1;
+    // Change tick stored ticks were last clamped at
+    std::uint32_t m_lastTickCheck = 1;
+
+    std::unique_ptr<util::ThreadPool> m_threadPool;
+    // Guards deferred structural changes recorded by worker threads during a parallel query
+    std::unique_ptr<std::recursive_mutex> m_parallelMutex;
+    std::uint32_t m_parallelCount = 0;
+    // Ids handed out during the current parallel region, added to the id list and entries once it ends
+    std::size_t m_pendingIds = 0;
+    // Advanced at the start and end of each parallel region to order the commands recorded in it
+    std::uint32_t m_parallelEpoch = 0;
 
     void completeCreation (EntityId id, EntityId parent);
+
+    [[nodiscard]] bool isDeferred () noexcept {
+        return std::atomic_ref{m_deferCount}.load(std::memory_order_relaxed);
+    }
+
+    EntityId newId ();
+    void addPendingIds ();
+    [[nodiscard]] bool isPendingId (EntityId id) const noexcept;
+    void reserveIds (std::span<EntityId> ids);
+    // Raises OnInsert for every component of the entities added to archetype from start onwards
+    void raiseBatchInsert (Archetype& archetype, std::size_t start);
+
+    template <typename... Components>
+    void spawnInto (std::span<const EntityId> ids, const Components&... components) {
+        std::array sparse{sparseSet(meta::TypeIndex::Get<Components>())...};
+        if (std::ranges::any_of(sparse, [] (auto* set) { return set; })) {
+            spawnSparse(ids, sparse, std::index_sequence_for<Components...>{}, components...);
+            return;
+        }
+
+        auto* archetype = findArchetype(detail::ArchetypeKey::Make<Components...>());
+        PHENYL_DASSERT_MSG(archetype->getKey().size() == sizeof...(Components),
+            "Duplicate component types passed to spawnBatch()");
+
+        auto start = archetype->size();
+        archetype->reserve(start + ids.size());
+        for (auto id : ids) {
+            m_relationships.add(id, EntityId{}, changeTick());
+            archetype->addEntity(id);
+            (archetype->template getComponent<Components>().emplace(components), ...);
+            archetype->markAdded(archetype->size() - 1);
+        }
+
+        raiseBatchInsert(*archetype, start);
+    }
+
+    // spawnInto() for batches that include sparse set components, which are inserted after the archetype rows
+    template <typename... Components, std::size_t... Is>
+    void spawnSparse (std::span<const EntityId> ids,
+        const std::array<detail::SparseComponentSet*, sizeof...(Components)>& sparse, std::index_sequence<Is...>,
+        const Components&... components) {
+        std::vector<meta::TypeIndex> types;
+        ((sparse[Is] ? void() : void(types.emplace_back(meta::TypeIndex::Get<Components>()))), ...);
+        std::ranges::sort(types);
+
+        auto* archetype = findArchetype(detail::ArchetypeKey{std::move(types)});
+        auto start = archetype->size();
+        archetype->reserve(start + ids.size());
+        for (auto id : ids) {
+            m_relationships.add(id, EntityId{}, changeTick());
+            archetype->addEntity(id);
+            ((sparse[Is] ? void() : void(archetype->template getComponent<Components>().emplace(components))), ...);
+            archetype->markAdded(archetype->size() - 1);
+        }
+
+        raiseBatchInsert(*archetype, start);
+
+        for (auto id : ids) {
+            ((sparse[Is] ? sparse[Is]->template emplace<Components>(id, components) : void()), ...);
+        }
+    }
+
+    void snapshotInto (WorldSnapshot& snapshot, const WorldSnapshot* base);
+
     void removeInt (EntityId id, bool updateParent);
+    void removeBatch ();
+    void detachRemoved (EntityId id, bool updateParent);
+
+    [[nodiscard]] detail::SparseComponentSet* sparseSet (meta::TypeIndex type) const noexcept {
+        if (m_sparseSets.empty()) {
+            return nullptr;
+        }
+
+        auto it = m_sparseSets.find(type);
+        return it != m_sparseSets.end() ? it->second.get() : nullptr;
+    }
 
     detail::QueryKey makeQueryKey (std::span<meta::TypeIndex> types);
     std::shared_ptr<QueryArchetypes> makeQueryArchetypes (detail::QueryKey key);
-    void cleanupQueryArchetypes ();
 
     detail::UntypedComponent* findComponent (meta::TypeIndex compType) override;
     Archetype* findArchetype (const detail::ArchetypeKey& key) override;
@@ -206,19 +400,49 @@ private:
     void onComponentInsert (EntityId id, meta::TypeIndex compType, std::byte* ptr) override;
     void onComponentRemove (EntityId id, meta::TypeIndex compType, std::byte* ptr) override;
 
-    void deferInsert (EntityId id, meta::TypeIndex compType, std::byte* ptr);
-    void deferErase (EntityId id, meta::TypeIndex compType);
-    void deferApply (EntityId id, std::function<void(Entity)> applyFunc);
+    // Raises OnInsert for components just added to the entity by a single move
+    void raiseInserts (EntityId id, std::span<const meta::TypeIndex> compTypes);
+    void eraseComponents (EntityId id, std::span<const meta::TypeIndex> compTypes);
 
-    void instantiatePrefab (EntityId id, const detail::PrefabFactories& factories);
+    void instantiatePrefab (EntityId id, const PrefabEntry& entry);
+    // Builds new entities from the prefab entry directly into its archetype, under the matching parents if given
+    void spawnPrefabRows (std::span<const EntityId> ids, std::span<const EntityId> parents, const PrefabEntry& entry);
+    void instantiateSparse (EntityId id, const PrefabEntry& entry);
 
     void raiseSignal (EntityId id, meta::TypeIndex signalType, std::byte* ptr);
 
+    // Handlers are stored with their concrete type, so calling one does not go through a std::function
+    template <typename Signal, typename... Args, typename F>
+    void addSignalHandler (F&& fn) {
+        detail::SignalHandlerVector<Signal>* handlerVec;
+        auto vecIt = m_signalHandlerVectors.find(meta::TypeIndex::Get<Signal>());
+        if (vecIt != m_signalHandlerVectors.end()) {
+            handlerVec = static_cast<detail::SignalHandlerVector<Signal>*>(vecIt->second.get());
+        } else {
+            auto newVec = std::make_unique<detail::SignalHandlerVector<Signal>>(*this);
+            if (m_signalDeferCount) {
+                newVec->defer();
+            }
+            handlerVec = newVec.get();
+            m_signalHandlerVectors.emplace(meta::TypeIndex::Get<Signal>(), std::move(newVec));
+        }
+
+        handlerVec->addHandler(std::make_unique<detail::SignalHandler2<Signal, std::remove_cvref_t<F>, Args...>>(
+            query<Args...>(), std::forward<F>(fn)));
+    }
+
     void deferRemove ();
     void deferRemoveEnd ();
+    void runCommands ();
+    void advanceParallelEpoch ();
+    // Brings stored ticks older than detail::MaxTickAge forward so they stay comparable after the tick wraps
+    void clampTicks ();
+
+    std::unique_lock<std::recursive_mutex> parallelLock () const;
 
     friend Entity;
     friend ChildrenView;
     friend PrefabManager;
+    friend QueryArchetypes;
 };
 } // namespace phenyl::core
@@ -17,6 +17,6 @@ void Core2DPlugin::init (PhenylRuntime& runtime) {
     runtime.addComponent<Transform2D>("Transform2D");
     runtime.addComponent<GlobalTransform2D>("GlobalTransform2D");
 
-    runtime.addHierarchicalSystem<PostUpdate>("GlobalTransform2D::PropagateTransforms",
+    runtime.addHierarchicalSystem<PostUpdate, Changed<Transform2D>>("GlobalTransform2D::PropagateTransforms",
         &GlobalTransform2D::PropagateTransforms);
 }
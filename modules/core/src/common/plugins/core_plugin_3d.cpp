@@ -17,6 +17,6 @@ void Core3DPlugin::init (PhenylRuntime& runtime) {
     runtime.addComponent<Transform3D>("Transform3D");
     runtime.addComponent<GlobalTransform3D>("GlobalTransform3D");
 
-    runtime.addHierarchicalSystem<PostUpdate>("GlobalTransform3D::PropagateTransforms",
+    runtime.addHierarchicalSystem<PostUpdate, Changed<Transform3D>>("GlobalTransform3D::PropagateTransforms",
         &GlobalTransform3D::PropagateTransforms);
 }
@@ -0,0 +1,21 @@
+#include "core/plugins/rollback_plugin.h"
+
+#include "core/runtime.h"
+
+using namespace phenyl::core;
+
+RollbackPlugin::RollbackPlugin (std::size_t frames) : m_frames{frames} {}
+
+RollbackPlugin::~RollbackPlugin () = default;
+
+std::string_view RollbackPlugin::getName () const noexcept {
+    return "RollbackPlugin";
+}
+
+void RollbackPlugin::init (PhenylRuntime& runtime) {
+    m_rollback = std::make_unique<Rollback>(runtime, m_frames);
+    runtime.addResource(m_rollback.get());
+
+    // Recorded once the timestep's deferred changes have been applied, after both FixedUpdate and PhysicsUpdate
+    runtime.addFixedTimestepCallback([rollback = m_rollback.get()] () { rollback->record(); });
+}
@@ -0,0 +1,78 @@
+#include "core/rollback.h"
+
+#include "core/detail/loggers.h"
+#include "core/runtime.h"
+
+using namespace phenyl::core;
+
+static phenyl::Logger LOGGER{"ROLLBACK", detail::COMMON_LOGGER};
+
+Rollback::Rollback (PhenylRuntime& runtime, std::size_t capacity) : m_runtime{runtime}, m_slots(capacity) {
+    PHENYL_ASSERT_MSG(capacity, "Rollback must keep at least one frame");
+}
+
+bool Rollback::canRewind (std::uint64_t frame) const noexcept {
+    return slot(frame);
+}
+
+void Rollback::rewind (std::uint64_t frame) {
+    const auto* target = slot(frame);
+    PHENYL_ASSERT_MSG(target, "Attempted to rewind to frame {}, which is not stored (current frame {})", frame,
+        m_frame);
+
+    PHENYL_TRACE(LOGGER, "Rewinding from frame {} to frame {}", m_frame, frame);
+    m_runtime.world().restore(target->snapshot);
+    m_frame = frame;
+}
+
+void Rollback::resimulate (std::uint64_t frame, const std::function<void(std::uint64_t)>& beforeStep) {
+    auto target = m_frame;
+    rewind(frame);
+
+    // Each timestep records its frame again, replacing the state it had before
+    while (m_frame < target) {
+        if (beforeStep) {
+            beforeStep(m_frame + 1);
+        }
+        m_runtime.runFixedTimestep();
+    }
+}
+
+std::size_t Rollback::frameMemory (std::uint64_t frame) const {
+    const auto* stored = slot(frame);
+    return stored ? stored->snapshot.memoryUsage() : 0;
+}
+
+std::size_t Rollback::memoryUsage () const noexcept {
+    std::size_t total = 0;
+    for (const auto& stored : m_slots) {
+        total += stored.snapshot.memoryUsage();
+    }
+    return total;
+}
+
+std::string_view Rollback::getName () const noexcept {
+    return "phenyl::Rollback";
+}
+
+void Rollback::record () {
+    m_frame++;
+    auto& next = m_slots[m_frame % m_slots.size()];
+
+    const auto* prev = slot(m_frame - 1);
+    if (prev && prev != &next) {
+        m_runtime.world().snapshot(next.snapshot, prev->snapshot);
+    } else {
+        m_runtime.world().snapshot(next.snapshot);
+    }
+    next.frame = m_frame;
+}
+
+const Rollback::Slot* Rollback::slot (std::uint64_t frame) const noexcept {
+    if (frame > m_frame || m_frame - frame >= m_slots.size()) {
+        return nullptr;
+    }
+
+    const auto& stored = m_slots[frame % m_slots.size()];
+    return stored.frame == frame && !stored.snapshot.empty() ? &stored : nullptr;
+}
@@ -29,6 +29,16 @@ std::size_t Archetype::addEntity (EntityId id) {
     return pos;
 }
 
+void Archetype::reserve (std::size_t capacity) {
+    if (capacity > m_entityIds.capacity()) {
+        // Keep growth geometric when reserving a few rows at a time
+        m_entityIds.reserve(std::max(capacity, m_entityIds.capacity() * 2));
+    }
+    for (auto& [_, vec] : m_components) {
+        vec->reserve(capacity);
+    }
+}
+
 void Archetype::remove (std::size_t pos) {
     PHENYL_DASSERT(pos < size());
 
@@ -43,6 +53,31 @@ void Archetype::remove (std::size_t pos) {
     m_entityIds.pop_back();
 }
 
+void Archetype::removeRows (std::vector<std::size_t>& positions) {
+    // Removing from the back first means the row swapped in is never one that is also being removed
+    std::ranges::sort(positions, std::greater{});
+    PHENYL_DASSERT(std::ranges::adjacent_find(positions) == positions.end());
+    PHENYL_DASSERT(positions.empty() || positions.front() < size());
+
+    for (auto& [_, vec] : m_components) {
+        for (auto pos : positions) {
+            vec->remove(pos);
+        }
+    }
+
+    for (auto pos : positions) {
+        m_entityIds[pos] = m_entityIds.back();
+        m_entityIds.pop_back();
+    }
+
+    // Rows may be swapped more than once, so entries are only updated for where they end up
+    for (auto pos : positions) {
+        if (pos < size()) {
+            m_manager.updateEntityEntry(m_entityIds[pos], this, pos);
+        }
+    }
+}
+
 void Archetype::clear () {
     for (auto& [_, vec] : m_components) {
         vec->clear();
@@ -50,14 +85,50 @@ void Archetype::clear () {
     m_entityIds.clear();
 }
 
-void Archetype::instantiatePrefab (const detail::PrefabFactories& factories, std::size_t pos) {
+void Archetype::shrinkToFit () {
+    for (auto& [_, vec] : m_components) {
+        vec->shrinkToFit();
+    }
+    m_entityIds.shrink_to_fit();
+
+    m_addArchetypes = {};
+    m_removeArchetypes = {};
+    m_addSetArchetypes = {};
+    m_removeSetArchetypes = {};
+}
+
+void Archetype::instantiatePrefab (const detail::PrefabFactories& factories, const detail::ArchetypeKey& key,
+    std::size_t pos) {
     PHENYL_DASSERT(pos < size());
 
-    auto* archetype = m_manager.findArchetype(m_key.with(factories | std::ranges::views::keys));
-    PHENYL_DASSERT(archetype);
-    auto newPos = archetype->moveFrom(*this, pos);
+    auto& archetype = getWith(key);
+    auto newPos = archetype.moveFrom(*this, pos);
     remove(pos);
-    archetype->instantiateInto(factories, newPos);
+    archetype.instantiateInto(factories, newPos);
+}
+
+Archetype& Archetype::getWith (const detail::ArchetypeKey& addedKey) {
+    auto it = m_addSetArchetypes.find(addedKey);
+    if (it != m_addSetArchetypes.end()) {
+        return *it->second;
+    }
+
+    auto* archetype = m_manager.findArchetype(m_key.keyUnion(addedKey));
+    PHENYL_DASSERT(archetype);
+    m_addSetArchetypes.emplace(addedKey, archetype);
+    return *archetype;
+}
+
+Archetype& Archetype::getWithout (const detail::ArchetypeKey& removedKey) {
+    auto it = m_removeSetArchetypes.find(removedKey);
+    if (it != m_removeSetArchetypes.end()) {
+        return *it->second;
+    }
+
+    auto* archetype = m_manager.findArchetype(m_key.keyDifference(removedKey));
+    PHENYL_DASSERT(archetype);
+    m_removeSetArchetypes.emplace(removedKey, archetype);
+    return *archetype;
 }
 
 UntypedComponentVector* Archetype::tryGetVector (meta::TypeIndex type) const {
@@ -95,6 +166,24 @@ std::size_t Archetype::moveFrom (Archetype& other, std::size_t pos) {
     return newPos;
 }
 
+void Archetype::markQuery (std::size_t queryId, bool matches) {
+    if (queryId >= m_queryMarks.size()) {
+        if (!matches) {
+            return;
+        }
+        m_queryMarks.resize(queryId + 1);
+    }
+
+    m_queryMarks[queryId] = matches;
+}
+
+void Archetype::markAdded (std::size_t pos) {
+    auto tick = changeTick();
+    for (auto& [_, vec] : m_components) {
+        vec->markAdded(pos, tick);
+    }
+}
+
 void Archetype::instantiateInto (const detail::PrefabFactories& factories, std::size_t pos) {
     PHENYL_DASSERT(pos == size() - 1);
     std::vector<meta::TypeIndex> newComps;
@@ -119,6 +208,11 @@ void Archetype::instantiateInto (const detail::PrefabFactories& factories, std::
         }
     }
 
+    auto tick = changeTick();
+    for (auto c : newComps) {
+        m_components[c]->markAdded(pos, tick);
+    }
+
     // Raise insert signals for only new components
     for (auto c : newComps) {
         m_manager.onComponentInsert(m_entityIds.back(), c, m_components[c]->getUntyped(pos));
@@ -0,0 +1,144 @@
+#include "core/component/command_buffer.h"
+
+#include "core/world.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace phenyl::core;
+
+namespace {
+// Order key of commands recorded by the calling thread inside a task: the key of the task's region, the task index and
+// a counter advanced around each nested region the task starts. Empty outside of tasks
+thread_local std::vector<std::uint32_t> TaskOrder;
+} // namespace
+
+CommandBuffer::~CommandBuffer () {
+    clear();
+}
+
+void CommandBuffer::remove (EntityId id) {
+    record(id, [] (auto& world, EntityId entityId) { world.remove(entityId); });
+}
+
+void CommandBuffer::run (World& world) {
+    m_runDepth++;
+    auto* curr = takeCommands();
+    while (curr) {
+        auto* next = curr->next;
+        RunCommand(curr, world);
+        curr = next;
+    }
+    finishRun();
+}
+
+void CommandBuffer::clear () {
+    for (auto* curr = m_head; curr; curr = curr->next) {
+        if (curr->destroy) {
+            curr->destroy(curr);
+        }
+    }
+
+    m_head = nullptr;
+    m_tail = nullptr;
+    m_size = 0;
+    if (!m_runDepth) {
+        m_arena.reset();
+    }
+}
+
+std::span<const std::uint32_t> CommandBuffer::nextOrder () {
+    std::span<const std::uint32_t> order = TaskOrder;
+    if (order.empty()) {
+        order = std::span{&m_epoch, 1};
+    }
+
+    auto* copy = static_cast<std::uint32_t*>(m_arena.allocate(order.size_bytes(), alignof(std::uint32_t)));
+    std::ranges::copy(order, copy);
+    return {copy, order.size()};
+}
+
+void CommandBuffer::append (Command* command) noexcept {
+    if (m_tail) {
+        m_tail->next = command;
+    } else {
+        m_head = command;
+    }
+    m_tail = command;
+    m_size++;
+}
+
+CommandBuffer::Command* CommandBuffer::takeCommands () noexcept {
+    m_tail = nullptr;
+    m_size = 0;
+    return std::exchange(m_head, nullptr);
+}
+
+void CommandBuffer::finishRun () noexcept {
+    PHENYL_DASSERT(m_runDepth);
+    // Outer runs may still be walking commands in the arena
+    if (!--m_runDepth && !m_head) {
+        m_arena.reset();
+    }
+}
+
+void CommandBuffer::RunMerged (std::span<CommandBuffer* const> buffers, World& world) {
+    std::vector<Command*> commands;
+    for (auto* buffer : buffers) {
+        buffer->m_runDepth++;
+        for (auto* curr = buffer->takeCommands(); curr; curr = curr->next) {
+            commands.emplace_back(curr);
+        }
+    }
+
+    // Even a single buffer may hold tasks out of order, as threads waiting on a nested region run other tasks. Stable
+    // so that commands of the same task keep the order they were recorded in
+    auto order = [] (const Command* command) { return std::span{command->order, command->orderSize}; };
+    auto less = [] (std::span<const std::uint32_t> lhs, std::span<const std::uint32_t> rhs) {
+        return std::ranges::lexicographical_compare(lhs, rhs);
+    };
+    if (!std::ranges::is_sorted(commands, less, order)) {
+        std::ranges::stable_sort(commands, less, order);
+    }
+    for (auto* command : commands) {
+        RunCommand(command, world);
+    }
+
+    for (auto* buffer : buffers) {
+        buffer->finishRun();
+    }
+}
+
+void CommandBuffer::RunTask (std::span<const std::uint32_t> regionOrder, std::size_t i,
+    const std::function<void(std::size_t)>& task) {
+    // Threads waiting on a nested region run other tasks, so the order of the waiting task is restored afterwards
+    auto prevOrder = std::move(TaskOrder);
+    TaskOrder.assign(regionOrder.begin(), regionOrder.end());
+    TaskOrder.emplace_back(static_cast<std::uint32_t>(i));
+    TaskOrder.emplace_back(0);
+
+    task(i);
+
+    TaskOrder = std::move(prevOrder);
+}
+
+std::vector<std::uint32_t> CommandBuffer::BeginNestedRegion () {
+    PHENYL_DASSERT_MSG(!TaskOrder.empty(), "Nested parallel region started outside of a task of the world");
+    TaskOrder.back()++;
+    return TaskOrder;
+}
+
+void CommandBuffer::EndNestedRegion () {
+    PHENYL_DASSERT(!TaskOrder.empty());
+    TaskOrder.back()++;
+}
+
+void CommandBuffer::RunCommand (Command* command, World& world) {
+    if (world.exists(command->id)) {
+        command->run(command, world);
+    }
+
+    if (command->destroy) {
+        command->destroy(command);
+    }
+}
@@ -1,6 +1,7 @@
 #include "core/detail/loggers.h"
 #include "core/signals/children_update.h"
 #include "core/world.h"
+#include "util/trace.h"
 
 using namespace phenyl::core;
 
@@ -9,20 +10,21 @@ static phenyl::Logger LOGGER{"MANAGER", phenyl::core::detail::COMPONENT_LOGGER};
 World::World (std::size_t capacity) :
     m_idList{capacity},
     m_relationships{capacity},
-    m_prefabManager{std::make_shared<PrefabManager>(*this)} {
+    m_prefabManager{std::make_shared<PrefabManager>(*this)},
+    m_parallelMutex{std::make_unique<std::recursive_mutex>()} {
+    m_commandBuffers.emplace_back(std::make_unique<CommandBuffer>());
+
     auto empty = std::make_unique<EmptyArchetype>(static_cast<detail::IArchetypeManager&>(*this));
     m_emptyArchetype = empty.get();
+    m_archetypeIndex.emplace(m_emptyArchetype->getKey(), m_emptyArchetype);
     m_archetypes.emplace_back(std::move(empty));
 }
 
 World::~World () = default;
 
 Entity World::create (EntityId parent) {
-    auto id = m_idList.newId();
-
-    if (id.pos() == m_entityEntries.size()) {
-        m_entityEntries.emplace_back(nullptr, 0);
-    }
+    auto lock = parallelLock();
+    auto id = newId();
 
     if (m_deferCount) {
         m_deferredCreations.emplace_back(id, parent);
@@ -34,11 +36,13 @@ Entity World::create (EntityId parent) {
 }
 
 void World::remove (EntityId id) {
-    if (!m_idList.check(id)) {
+    // Entities created in a parallel region are pending until it ends, and removals are deferred until then anyway
+    if (!exists(id)) {
         PHENYL_LOGE(LOGGER, "Attempted to delete invalid entity {}!", id.value());
         return;
     }
 
+    auto lock = parallelLock();
     if (m_removeDeferCount) {
         m_deferredRemovals.emplace_back(id);
     } else {
@@ -47,13 +51,21 @@ void World::remove (EntityId id) {
 }
 
 void World::reparent (EntityId id, EntityId parent) {
+    auto lock = parallelLock();
+    if (m_parallelCount && (!m_idList.check(id) || (parent && !m_idList.check(parent)))) {
+        // Pending entities have no relationships until their creation completes
+        PHENYL_DASSERT(exists(id) && (!parent || exists(parent)));
+        m_deferredReparents.emplace_back(id, parent);
+        return;
+    }
+
     auto oldParent = m_relationships.parent(id);
     if (oldParent) {
         entity(oldParent).raise(OnRemoveChild{entity(id)});
     }
 
     m_relationships.removeFromParent(id);
-    m_relationships.setParent(id, parent);
+    m_relationships.setParent(id, parent, changeTick());
 
     if (parent) {
         entity(parent).raise(OnAddChild{entity(id)});
@@ -68,12 +80,17 @@ void World::clear () {
         i->clear();
     }
 
+    for (auto& [_, set] : m_sparseSets) {
+        set->clear();
+    }
+
     for (auto& entry : m_entityEntries) {
         entry.archetype = nullptr;
         entry.pos = 0;
     }
 
     m_idList.clear();
+    m_relationships.reset();
 }
 
 Entity World::entity (EntityId id) noexcept {
@@ -94,8 +111,20 @@ std::string_view World::componentName (meta::TypeIndex type) const noexcept {
     return it != m_components.end() ? it->second->name() : std::string_view{};
 }
 
+std::vector<phenyl::meta::TypeIndex> World::interfaceImplementors (meta::TypeIndex interface) const {
+    std::vector<meta::TypeIndex> implementors;
+    for (const auto& [type, comp] : m_components) {
+        auto interfaces = comp->interfaces();
+        if (std::ranges::find(interfaces, interface) != interfaces.end()) {
+            implementors.emplace_back(type);
+        }
+    }
+    return implementors;
+}
+
 void World::defer () {
-    if (m_deferCount++) {
+    auto lock = parallelLock();
+    if (std::atomic_ref{m_deferCount}.fetch_add(1, std::memory_order_relaxed)) {
         // Already deferred
         return;
     }
@@ -106,35 +135,44 @@ void World::defer () {
 }
 
 void World::deferEnd () {
-    if (--m_deferCount) {
+    auto lock = parallelLock();
+    if (std::atomic_ref{m_deferCount}.fetch_sub(1, std::memory_order_relaxed) != 1) {
         // Still deferring
         return;
     }
 
+    util::TraceZone zone{"world", "World::deferEnd"};
+
     // Create deferred entities
     for (auto [id, parent] : m_deferredCreations) {
         completeCreation(id, parent);
     }
     m_deferredCreations.clear();
 
-    // Insert / Erase deferred components
-    for (auto& [_, comp] : m_components) {
-        comp->deferEnd();
+    for (auto [id, parent] : m_deferredReparents) {
+        if (exists(id) && (!parent || exists(parent))) {
+            reparent(id, parent);
+        }
     }
+    m_deferredReparents.clear();
+
+    for (auto& spawn : m_deferredSpawns) {
+        spawn();
+    }
+    m_deferredSpawns.clear();
 
     // Do deferred instantiations
     m_prefabManager->deferEnd();
 
-    // Apply deferred functions
-    for (auto& [id, func] : m_deferredApplys) {
-        if (exists(id)) {
-            func(entity(id));
-        }
-    }
-    m_deferredApplys.clear();
+    // Insert / erase / apply to deferred components
+    runCommands();
 
     deferSignalsEnd();
     deferRemoveEnd();
+
+    if (changeTick() - m_lastTickCheck >= detail::TickCheckInterval) {
+        clampTicks();
+    }
 }
 
 void World::deferSignals () {
@@ -154,13 +192,43 @@ void World::deferSignalsEnd () {
         return;
     }
 
-    deferRemove();
     for (auto& [_, vec] : m_signalHandlerVectors) {
         vec->deferEnd();
     }
+
+    if (std::ranges::none_of(m_signalHandlerVectors, [] (const auto& pair) { return pair.second->hasDeferred(); })) {
+        return;
+    }
+
+    // Signals are dispatched over archetype rows, so structural changes made by handlers must wait until every signal
+    // has been handled. Signals raised by handlers are deferred again and dispatched by the deferEnd()
+    deferRemove();
+    defer();
+    {
+        util::TraceZone zone{"world", "World::dispatchSignals"};
+        for (auto& [_, vec] : m_signalHandlerVectors) {
+            m_dispatchedSignals += vec->dispatchDeferred();
+        }
+    }
+    deferEnd();
     deferRemoveEnd();
 }
 
+void World::clampTicks () {
+    auto now = changeTick();
+    for (auto& archetype : m_archetypes) {
+        for (auto& [_, vec] : archetype->m_components) {
+            vec->clampTicks(now, detail::MaxTickAge);
+        }
+    }
+    for (auto& [_, set] : m_sparseSets) {
+        set->clampTicks(now, detail::MaxTickAge);
+    }
+    m_relationships.clampTicks(now, detail::MaxTickAge);
+
+    m_lastTickCheck = now;
+}
+
 void World::deferRemove () {
     m_removeDeferCount++;
 }
@@ -170,19 +238,32 @@ void World::deferRemoveEnd () {
         return;
     }
 
-    // In case removal happens while removing deferred entities
-    for (std::size_t i = 0; i < m_deferredRemovals.size(); i++) {
-        if (exists(m_deferredRemovals[i])) {
-            removeInt(m_deferredRemovals[i], true);
-        }
+    if (!m_deferredRemovals.empty()) {
+        removeBatch();
     }
-    m_deferredRemovals.clear();
 }
 
 PrefabBuilder World::buildPrefab () {
     return m_prefabManager->makeBuilder();
 }
 
+std::size_t World::takeDispatchedSignals () noexcept {
+    return std::exchange(m_dispatchedSignals, 0);
+}
+
+phenyl::util::ThreadPool& World::threadPool () {
+    if (!m_threadPool) {
+        m_threadPool = std::make_unique<util::ThreadPool>();
+
+        // Created before any worker can record commands
+        while (m_commandBuffers.size() < m_threadPool->concurrency()) {
+            m_commandBuffers.emplace_back(std::make_unique<CommandBuffer>());
+        }
+    }
+
+    return *m_threadPool;
+}
+
 World::iterator World::begin () {
     return iterator{this, m_idList.cbegin()};
 }
@@ -192,7 +273,7 @@ World::iterator World::end () {
 }
 
 void World::completeCreation (EntityId id, EntityId parent) {
-    m_relationships.add(id, parent);
+    m_relationships.add(id, parent, changeTick());
 
     // Entities start out in empty archetype
     m_emptyArchetype->add(id);
@@ -202,6 +283,109 @@ void World::completeCreation (EntityId id, EntityId parent) {
     }
 }
 
+EntityId World::newId () {
+    if (m_parallelCount) {
+        // Other threads look up entities without locking, so the id list and entries must not change until the
+        // parallel region ends. Freed ids are not reused as their slots may still be read
+        return EntityId{1, static_cast<unsigned int>(m_idList.maxIndex() + ++m_pendingIds)};
+    }
+
+    auto id = m_idList.newId();
+    if (id.pos() == m_entityEntries.size()) {
+        m_entityEntries.emplace_back(nullptr, 0);
+    }
+    return id;
+}
+
+void World::addPendingIds () {
+    for (; m_pendingIds; m_pendingIds--) {
+        [[maybe_unused]] auto id = m_idList.appendId();
+        PHENYL_DASSERT(id.pos() == m_entityEntries.size());
+        m_entityEntries.emplace_back(nullptr, 0);
+    }
+}
+
+bool World::isPendingId (EntityId id) const noexcept {
+    auto lock = parallelLock();
+    return id.pos() < m_idList.maxIndex() + m_pendingIds && id == EntityId{1, id.pos() + 1};
+}
+
+void World::reserveIds (std::span<EntityId> ids) {
+    for (auto& id : ids) {
+        id = newId();
+    }
+}
+
+void World::raiseBatchInsert (Archetype& archetype, std::size_t start) {
+    std::vector<EntityId> ids{archetype.m_entityIds.begin() + static_cast<std::ptrdiff_t>(start),
+        archetype.m_entityIds.end()};
+    for (auto type : archetype.getKey()) {
+        auto& comp = m_components[type];
+        for (auto id : ids) {
+            // Earlier handlers may have moved the entity, removed the component or removed the entity
+            if (!exists(id)) {
+                continue;
+            }
+
+            const auto& entry = m_entityEntries[id.pos()];
+            if (auto* vec = entry.archetype ? entry.archetype->tryGetVector(type) : nullptr) {
+                comp->onInsert(id, vec->getUntyped(entry.pos));
+            }
+        }
+    }
+}
+
+void World::raiseInserts (EntityId id, std::span<const meta::TypeIndex> compTypes) {
+    for (auto type : compTypes) {
+        // Earlier handlers may have moved the entity, removed the component or removed the entity
+        if (!exists(id)) {
+            return;
+        }
+
+        const auto& entry = m_entityEntries[id.pos()];
+        if (auto* vec = entry.archetype ? entry.archetype->tryGetVector(type) : nullptr) {
+            m_components[type]->onInsert(id, vec->getUntyped(entry.pos));
+        }
+    }
+}
+
+void World::eraseComponents (EntityId id, std::span<const meta::TypeIndex> compTypes) {
+    // OnRemove is raised for every component before any are removed
+    for (auto type : compTypes) {
+        if (!exists(id)) {
+            return;
+        }
+
+        if (auto* set = sparseSet(type)) {
+            set->erase(id);
+            continue;
+        }
+
+        const auto& entry = m_entityEntries[id.pos()];
+        if (entry.archetype && entry.archetype->getKey().has(type)) {
+            m_components[type]->onRemove(id, entry.archetype->tryGetVector(type)->getUntyped(entry.pos));
+        }
+    }
+
+    // Handlers may have moved the entity or removed some of the components already
+    if (!exists(id)) {
+        return;
+    }
+
+    auto [archetype, pos] = m_entityEntries[id.pos()];
+    std::vector<meta::TypeIndex> removed;
+    std::ranges::copy_if(compTypes, std::back_inserter(removed),
+        [&] (meta::TypeIndex type) { return archetype->getKey().has(type); });
+    if (removed.empty()) {
+        return;
+    }
+    std::ranges::sort(removed);
+
+    auto& dest = archetype->getWithout(detail::ArchetypeKey{std::move(removed)});
+    dest.moveFrom(*archetype, pos);
+    archetype->remove(pos);
+}
+
 void World::removeInt (EntityId id, bool updateParent) {
     if (updateParent) {
         auto parentId = m_relationships.parent(id);
@@ -228,6 +412,77 @@ void World::removeInt (EntityId id, bool updateParent) {
     entry.archetype = nullptr;
     entry.pos = 0;
 
+    for (auto& [_, set] : m_sparseSets) {
+        set->remove(id);
+    }
+
+    m_idList.removeId(id);
+}
+
+void World::removeBatch () {
+    // Parents are told first. Removals stay deferred meanwhile, so handlers that remove entities add to this batch
+    m_removeDeferCount++;
+    std::vector<bool> signalled(m_entityEntries.size());
+    for (std::size_t i = 0; i < m_deferredRemovals.size(); i++) {
+        auto id = m_deferredRemovals[i];
+        if (!exists(id) || (id.pos() < signalled.size() && signalled[id.pos()])) {
+            continue;
+        }
+
+        if (id.pos() < signalled.size()) {
+            signalled[id.pos()] = true;
+        }
+        if (auto parentId = m_relationships.parent(id)) {
+            entity(parentId).raise(OnRemoveChild{entity(id)});
+        }
+    }
+    m_removeDeferCount--;
+
+    // No handlers run from here on, so the collected rows stay where they are until compacted
+    for (auto id : m_deferredRemovals) {
+        if (exists(id)) {
+            detachRemoved(id, true);
+        }
+    }
+    m_deferredRemovals.clear();
+
+    // Batches usually touch few archetypes, so rows are bucketed with a linear search
+    std::vector<std::pair<Archetype*, std::vector<std::size_t>>> buckets;
+    for (auto [archetype, pos] : m_removedRows) {
+        auto it = std::ranges::find(buckets, archetype, [] (const auto& bucket) { return bucket.first; });
+        if (it == buckets.end()) {
+            it = buckets.emplace(buckets.end(), archetype, std::vector<std::size_t>{});
+        }
+        it->second.emplace_back(pos);
+    }
+    m_removedRows.clear();
+
+    for (auto& [archetype, positions] : buckets) {
+        archetype->removeRows(positions);
+    }
+}
+
+void World::detachRemoved (EntityId id, bool updateParent) {
+    auto curr = m_relationships.entityChildren(id);
+    while (curr) {
+        auto next = m_relationships.next(curr);
+        detachRemoved(curr, false);
+        curr = next;
+    }
+
+    m_relationships.remove(id, updateParent);
+
+    PHENYL_DASSERT(id.pos() < m_entityEntries.size());
+    auto& entry = m_entityEntries[id.pos()];
+    PHENYL_DASSERT(entry.archetype);
+    m_removedRows.emplace_back(entry.archetype, entry.pos);
+    entry.archetype = nullptr;
+    entry.pos = 0;
+
+    for (auto& [_, set] : m_sparseSets) {
+        set->remove(id);
+    }
+
     m_idList.removeId(id);
 }
 
@@ -237,10 +492,9 @@ detail::UntypedComponent* World::findComponent (meta::TypeIndex compType) {
 }
 
 Archetype* World::findArchetype (const detail::ArchetypeKey& key) {
-    auto it = std::ranges::find_if(m_archetypes, [&] (const auto& arch) { return arch->getKey() == key; });
-
-    if (it != m_archetypes.end()) {
-        return it->get();
+    auto it = m_archetypeIndex.find(key);
+    if (it != m_archetypeIndex.end()) {
+        return it->second;
     }
 
     // Build new archetype
@@ -257,11 +511,13 @@ Archetype* World::findArchetype (const detail::ArchetypeKey& key) {
     auto archetype = std::make_unique<Archetype>(static_cast<detail::IArchetypeManager&>(*this), std::move(compVecs));
     auto* ptr = archetype.get();
     m_archetypes.emplace_back(std::move(archetype));
+    m_archetypeIndex.emplace(ptr->getKey(), ptr);
 
     // Update queries
-    cleanupQueryArchetypes();
     for (const auto& i : m_queryArchetypes) {
-        i.lock()->onNewArchetype(ptr);
+        if (auto query = i.lock()) {
+            query->onNewArchetype(ptr);
+        }
     }
 
     return ptr;
@@ -288,31 +544,59 @@ void World::onComponentRemove (EntityId id, meta::TypeIndex compType, std::byte*
     comp->onRemove(id, ptr);
 }
 
-void World::deferInsert (EntityId id, meta::TypeIndex compType, std::byte* ptr) {
-    PHENYL_DASSERT(m_deferCount);
-    PHENYL_DASSERT(m_components.contains(compType));
+void World::instantiatePrefab (EntityId id, const PrefabEntry& entry) {
+    PHENYL_DASSERT(exists(id));
 
-    auto& comp = m_components[compType];
-    comp->deferComp(id, ptr);
+    auto& entityEntry = m_entityEntries[id.pos()];
+    entityEntry.archetype->instantiatePrefab(entry.factories, entry.key, entityEntry.pos);
+    instantiateSparse(id, entry);
 }
 
-void World::deferErase (EntityId id, meta::TypeIndex compType) {
-    PHENYL_DASSERT(m_deferCount);
-    PHENYL_DASSERT(m_components.contains(compType));
-    auto& comp = m_components[compType];
-    comp->deferErase(id);
+void World::instantiateSparse (EntityId id, const PrefabEntry& entry) {
+    for (const auto& [type, factory] : entry.sparseFactories) {
+        auto* set = sparseSet(type);
+        PHENYL_DASSERT(set);
+        if (!set->contains(id)) {
+            set->make(id, *factory);
+        }
+    }
 }
 
-void World::deferApply (EntityId id, std::function<void(Entity)> applyFunc) {
-    PHENYL_DASSERT(m_deferCount);
-    m_deferredApplys.emplace_back(id, std::move(applyFunc));
-}
+void World::spawnPrefabRows (std::span<const EntityId> ids, std::span<const EntityId> parents,
+    const PrefabEntry& entry) {
+    PHENYL_DASSERT(entry.archetype);
+    PHENYL_DASSERT(parents.empty() || parents.size() == ids.size());
+    auto& archetype = *entry.archetype;
+
+    auto start = archetype.size();
+    archetype.reserve(start + ids.size());
+    for (std::size_t i = 0; i < ids.size(); i++) {
+        m_relationships.add(ids[i], parents.empty() ? EntityId{} : parents[i], changeTick());
+        archetype.addEntity(ids[i]);
+
+        // The archetype has exactly the prefab's components, in the same order
+        auto compIt = archetype.m_components.begin();
+        for (const auto& [type, factory] : entry.factories) {
+            PHENYL_DASSERT(compIt->first == type);
+            factory->make(compIt->second->insertUntyped());
+            ++compIt;
+        }
+        archetype.markAdded(archetype.size() - 1);
+    }
 
-void World::instantiatePrefab (EntityId id, const detail::PrefabFactories& factories) {
-    PHENYL_DASSERT(exists(id));
+    raiseBatchInsert(archetype, start);
 
-    auto& entry = m_entityEntries[id.pos()];
-    entry.archetype->instantiatePrefab(factories, entry.pos);
+    if (!entry.sparseFactories.empty()) {
+        for (auto id : ids) {
+            instantiateSparse(id, entry);
+        }
+    }
+
+    if (!parents.empty()) {
+        for (std::size_t i = 0; i < ids.size(); i++) {
+            entity(parents[i]).raise(OnAddChild{entity(ids[i])});
+        }
+    }
 }
 
 void World::raiseSignal (EntityId id, meta::TypeIndex signalType, std::byte* ptr) {
@@ -322,43 +606,126 @@ void World::raiseSignal (EntityId id, meta::TypeIndex signalType, std::byte* ptr
         return;
     }
 
+    auto lock = parallelLock();
     deferRemove();
-    vecIt->second->handle(id, ptr);
+    if (vecIt->second->handle(id, ptr)) {
+        m_dispatchedSignals++;
+    }
     deferRemoveEnd();
 }
 
+void World::runParallel (std::size_t numTasks, const std::function<void(std::size_t)>& task) {
+    PHENYL_DASSERT_MSG(isDeferred(), "Parallel iteration requires structural changes to be deferred");
+
+    if (util::ThreadPool::InTask()) {
+        // Nested inside another parallel region, which is already being tracked
+        PHENYL_DASSERT(m_parallelCount);
+        auto regionOrder = CommandBuffer::BeginNestedRegion();
+        threadPool().parallelFor(numTasks,
+            [&] (std::size_t i) { CommandBuffer::RunTask(regionOrder, i, task); });
+        CommandBuffer::EndNestedRegion();
+        return;
+    }
+
+    auto& pool = threadPool();
+    m_parallelCount++;
+    advanceParallelEpoch();
+    std::uint32_t regionOrder = m_parallelEpoch;
+    pool.parallelFor(numTasks,
+        [&] (std::size_t i) { CommandBuffer::RunTask(std::span{&regionOrder, 1}, i, task); });
+    advanceParallelEpoch();
+    m_parallelCount--;
+
+    // No other threads are reading entities any more
+    addPendingIds();
+}
+
+CommandBuffer& World::commandBuffer () {
+    PHENYL_DASSERT_MSG(isDeferred(), "Command buffers may only be recorded into while deferred");
+
+    auto index = util::ThreadPool::WorkerIndex();
+    PHENYL_DASSERT_MSG(index < m_commandBuffers.size(), "Command buffer requested by a thread of another pool");
+    return *m_commandBuffers[index];
+}
+
+void World::runCommands () {
+    std::vector<CommandBuffer*> pending;
+    for (const auto& buffer : m_commandBuffers) {
+        if (!buffer->empty()) {
+            pending.emplace_back(buffer.get());
+        }
+    }
+
+    if (!pending.empty()) {
+        CommandBuffer::RunMerged(pending, *this);
+    }
+
+    // Order keys only have to be comparable until their commands have run, so the epoch can start over instead of
+    // wrapping around
+    if (std::ranges::all_of(m_commandBuffers, [] (const auto& buffer) { return buffer->empty(); })) {
+        m_parallelEpoch = 0;
+        for (const auto& buffer : m_commandBuffers) {
+            buffer->m_epoch = 0;
+        }
+    }
+}
+
+void World::advanceParallelEpoch () {
+    m_parallelEpoch++;
+    for (const auto& buffer : m_commandBuffers) {
+        buffer->m_epoch = m_parallelEpoch;
+    }
+}
+
+std::unique_lock<std::recursive_mutex> World::parallelLock () const {
+    return m_parallelCount ? std::unique_lock{*m_parallelMutex} : std::unique_lock<std::recursive_mutex>{};
+}
+
 detail::QueryKey World::makeQueryKey (std::span<meta::TypeIndex> types) {
     std::ranges::sort(types);
+    // Filters may name components that are also queried
+    auto uniqueTypes = std::ranges::subrange{types.begin(), std::ranges::unique(types).begin()};
 
     std::vector<meta::TypeIndex> comps;
     std::vector<meta::TypeIndex> interfaces;
-    for (auto i : types) {
-        if (m_components.contains(i)) {
+    std::vector<meta::TypeIndex> sparse;
+    for (auto i : uniqueTypes) {
+        if (sparseSet(i)) {
+            sparse.emplace_back(i);
+        } else if (m_components.contains(i)) {
             comps.emplace_back(i);
         } else {
             interfaces.emplace_back(i);
         }
     }
 
-    return detail::QueryKey{detail::ArchetypeKey{std::move(comps)}, std::move(interfaces)};
+    return detail::QueryKey{detail::ArchetypeKey{std::move(comps)}, std::move(interfaces), std::move(sparse)};
 }
 
 std::shared_ptr<QueryArchetypes> World::makeQueryArchetypes (detail::QueryKey key) {
-    cleanupQueryArchetypes();
-
-    for (const auto& weakArch : m_queryArchetypes) {
-        if (auto ptr = weakArch.lock(); ptr->getKey() == key) {
+    auto id = m_queryArchetypes.size();
+    for (std::size_t i = 0; i < m_queryArchetypes.size(); i++) {
+        auto ptr = m_queryArchetypes[i].lock();
+        if (!ptr) {
+            // Reuse the first free id
+            id = std::min(id, i);
+        } else if (ptr->getKey() == key) {
             return ptr;
         }
     }
 
-    auto newArch = std::make_shared<QueryArchetypes>(*this, std::move(key));
-    m_queryArchetypes.emplace_back(newArch);
-    return newArch;
-}
+    auto newArch = std::make_shared<QueryArchetypes>(*this, std::move(key), id);
+    // Match existing archetypes in creation order, which also clears marks left by the previous owner of the id
+    for (const auto& archetype : m_archetypes) {
+        newArch->onNewArchetype(archetype.get());
+    }
 
-void World::cleanupQueryArchetypes () {
-    std::erase_if(m_queryArchetypes, [] (const auto& x) { return x.expired(); });
+    if (id == m_queryArchetypes.size()) {
+        m_queryArchetypes.emplace_back(newArch);
+    } else {
+        m_queryArchetypes[id] = newArch;
+    }
+    return newArch;
 }
 
 World::EntityIterator::value_type World::EntityIterator::operator* () const {
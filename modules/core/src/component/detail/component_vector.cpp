@@ -1,5 +1,11 @@
 #include "core/component/detail/component_vector.h"
 
+#include "core/component/detail/change_tick.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
 using namespace phenyl::core;
 
 UntypedComponentVector::UntypedComponentVector (meta::TypeIndex typeIndex, std::size_t dataSize,
@@ -7,16 +13,29 @@ UntypedComponentVector::UntypedComponentVector (meta::TypeIndex typeIndex, std::
     m_type{typeIndex},
     m_compSize{dataSize},
     m_size{0},
-    m_capacity{startCapacity} {
-    m_memory = std::make_unique<std::byte[]>(dataSize * startCapacity);
+    m_capacity{0},
+    m_chunkShift{static_cast<std::size_t>(
+        std::countr_zero(std::bit_floor(std::max<std::size_t>(CHUNK_BYTES / std::max<std::size_t>(dataSize, 1), 1))))},
+    m_chunkMask{(std::size_t{1} << m_chunkShift) - 1} {
+    if (isTag()) {
+        // All rows map to the one shared address in the first chunk
+        m_chunkShift = std::numeric_limits<std::size_t>::digits - 1;
+        m_chunkMask = 0;
+        m_chunks.emplace_back(std::make_unique<std::byte[]>(1));
+    }
+    guaranteeLength(startCapacity);
 }
 
 UntypedComponentVector::UntypedComponentVector (UntypedComponentVector&& other) noexcept :
     m_type{other.m_type},
-    m_memory{std::move(other.m_memory)},
+    m_chunks{std::move(other.m_chunks)},
     m_compSize{other.m_compSize},
     m_size{other.m_size},
-    m_capacity{other.m_capacity} {
+    m_capacity{other.m_capacity},
+    m_chunkShift{other.m_chunkShift},
+    m_chunkMask{other.m_chunkMask},
+    m_addedTicks{std::move(other.m_addedTicks)},
+    m_changedTicks{std::move(other.m_changedTicks)} {
     other.m_compSize = 0;
     other.m_size = 0;
     other.m_capacity = 0;
@@ -24,14 +43,18 @@ UntypedComponentVector::UntypedComponentVector (UntypedComponentVector&& other)
 
 UntypedComponentVector& UntypedComponentVector::operator= (UntypedComponentVector&& other) noexcept {
     PHENYL_DASSERT(m_type == other.m_type);
-    if (m_memory) {
-        deleteAllComps(m_memory.get(), m_memory.get() + m_compSize * m_capacity);
-    }
+    clear();
 
-    m_memory = std::move(other.m_memory);
+    m_chunks = std::move(other.m_chunks);
     m_compSize = other.m_compSize;
     m_size = other.m_size;
     m_capacity = other.m_capacity;
+    m_chunkShift = other.m_chunkShift;
+    m_chunkMask = other.m_chunkMask;
+    m_addedTicks = std::move(other.m_addedTicks);
+    m_changedTicks = std::move(other.m_changedTicks);
+    other.m_size = 0;
+    other.m_capacity = 0;
     return *this;
 }
 
@@ -39,34 +62,126 @@ std::byte* UntypedComponentVector::insertUntyped () {
     guaranteeLength(m_size + 1);
     PHENYL_DASSERT(m_capacity >= m_size + 1);
 
-    return m_memory.get() + (m_size++) * m_compSize;
+    m_addedTicks.emplace_back(0);
+    m_changedTicks.emplace_back(0);
+    return getUntyped(m_size++);
+}
+
+void UntypedComponentVector::reserve (std::size_t capacity) {
+    guaranteeLength(capacity);
+    if (capacity > m_addedTicks.capacity()) {
+        // Keep tick growth geometric when reserving a few rows at a time
+        auto tickCapacity = std::max(capacity, m_addedTicks.capacity() * RESIZE_FACTOR);
+        m_addedTicks.reserve(tickCapacity);
+        m_changedTicks.reserve(tickCapacity);
+    }
 }
 
 void UntypedComponentVector::moveFrom (UntypedComponentVector& other, std::size_t pos) {
     PHENYL_DASSERT(type() == other.type());
 
     auto* ptr = insertUntyped();
-    moveConstructComp(other.getUntyped(pos), ptr);
+    if (!isTag()) {
+        moveConstructComp(other.getUntyped(pos), ptr);
+    }
+
+    // Ticks follow the component between archetypes
+    m_addedTicks.back() = other.m_addedTicks[pos];
+    m_changedTicks.back() = other.m_changedTicks[pos];
+}
+
+void UntypedComponentVector::copyFrom (const UntypedComponentVector& other) {
+    PHENYL_DASSERT(type() == other.type());
+    PHENYL_DASSERT(m_compSize == other.m_compSize);
+    clear();
+
+    // Both vectors have the same chunk size, so each full chunk of other lines up with a chunk of this
+    guaranteeLength(other.m_size);
+    if (!isTag()) {
+        for (std::size_t start = 0; start < other.m_size; start += chunkRows()) {
+            const auto* chunk = other.m_chunks[start >> m_chunkShift].get();
+            copyAllComps(chunk, chunk + std::min(chunkRows(), other.m_size - start) * m_compSize,
+                m_chunks[start >> m_chunkShift].get());
+        }
+    }
+
+    m_size = other.m_size;
+    m_addedTicks.assign(other.m_addedTicks.begin(), other.m_addedTicks.end());
+    m_changedTicks.assign(other.m_changedTicks.begin(), other.m_changedTicks.end());
 }
 
 void UntypedComponentVector::remove (std::size_t pos) {
     PHENYL_DASSERT(pos < size());
 
-    if (pos == size() - 1) {
-        // Delete from back
-        deleteComp(getUntyped(pos));
-    } else {
-        // Swap from back
-        auto oldPos = size() - 1;
-        moveComp(getUntyped(oldPos), getUntyped(pos));
-        deleteComp(getUntyped(oldPos));
+    // Swap from back
+    auto lastPos = size() - 1;
+    if (!isTag()) {
+        if (pos != lastPos) {
+            moveComp(getUntyped(lastPos), getUntyped(pos));
+        }
+        deleteComp(getUntyped(lastPos));
     }
+
+    m_addedTicks[pos] = m_addedTicks[lastPos];
+    m_changedTicks[pos] = m_changedTicks[lastPos];
+    m_addedTicks.pop_back();
+    m_changedTicks.pop_back();
     m_size--;
 }
 
 void UntypedComponentVector::clear () {
-    deleteAllComps(m_memory.get(), m_memory.get() + m_size * m_compSize);
+    if (!isTag()) {
+        for (std::size_t start = 0; start < m_size; start += chunkRows()) {
+            auto* chunk = m_chunks[start >> m_chunkShift].get();
+            deleteAllComps(chunk, chunk + std::min(chunkRows(), m_size - start) * m_compSize);
+        }
+    }
     m_size = 0;
+    m_addedTicks.clear();
+    m_changedTicks.clear();
+}
+
+void UntypedComponentVector::markAllChanged (std::uint32_t tick) noexcept {
+    std::ranges::fill(m_changedTicks, tick);
+}
+
+void UntypedComponentVector::clampTicks (std::uint32_t now, std::uint32_t maxAge) noexcept {
+    for (auto& tick : m_addedTicks) {
+        tick = detail::ClampTick(tick, now, maxAge);
+    }
+    for (auto& tick : m_changedTicks) {
+        tick = detail::ClampTick(tick, now, maxAge);
+    }
+}
+
+void UntypedComponentVector::shrinkToFit () {
+    m_addedTicks.shrink_to_fit();
+    m_changedTicks.shrink_to_fit();
+    if (isTag()) {
+        m_capacity = m_size;
+        return;
+    }
+
+    if (!m_size) {
+        m_chunks.clear();
+        m_capacity = 0;
+    } else if (m_size < chunkRows()) {
+        // Only the first chunk is needed, which is cut down to the rows in it
+        m_chunks.resize(1);
+        if (m_capacity > m_size) {
+            auto newChunk = std::make_unique_for_overwrite<std::byte[]>(m_size * m_compSize);
+            moveAllComps(m_chunks[0].get(), m_chunks[0].get() + m_size * m_compSize, newChunk.get());
+            m_chunks[0] = std::move(newChunk);
+        }
+        m_capacity = m_size;
+    } else {
+        m_chunks.resize((m_size + chunkRows() - 1) >> m_chunkShift);
+        m_capacity = m_chunks.size() * chunkRows();
+    }
+}
+
+bool UntypedComponentVector::changedSince (std::uint32_t tick) const noexcept {
+    return std::ranges::any_of(m_changedTicks, [tick] (auto changed) { return detail::TickNewer(changed, tick); });
 }
 
 void UntypedComponentVector::guaranteeLength (std::size_t newLen) {
@@ -74,10 +189,30 @@ void UntypedComponentVector::guaranteeLength (std::size_t newLen) {
         return;
     }
 
-    std::size_t newCapacity = m_capacity * RESIZE_FACTOR;
-    std::unique_ptr<std::byte[]> newMemory = std::make_unique<std::byte[]>(newCapacity * m_compSize);
-    moveAllComps(m_memory.get(), m_memory.get() + m_capacity * m_compSize, newMemory.get());
+    if (isTag()) {
+        m_capacity = newLen;
+        return;
+    }
+
+    if (m_capacity < chunkRows()) {
+        // Grow the first chunk, which moves less than a chunk's worth of rows
+        std::size_t newCapacity = std::min(std::max(m_capacity * RESIZE_FACTOR, newLen), chunkRows());
+        auto newChunk = std::make_unique_for_overwrite<std::byte[]>(newCapacity * m_compSize);
+        if (m_size) {
+            moveAllComps(m_chunks[0].get(), m_chunks[0].get() + m_size * m_compSize, newChunk.get());
+        }
 
-    m_capacity = newCapacity;
-    m_memory = std::move(newMemory);
+        if (m_chunks.empty()) {
+            m_chunks.emplace_back(std::move(newChunk));
+        } else {
+            m_chunks[0] = std::move(newChunk);
+        }
+        m_capacity = newCapacity;
+    }
+
+    // Rows in full chunks are never moved
+    while (m_capacity < newLen) {
+        m_chunks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(chunkRows() * m_compSize));
+        m_capacity += chunkRows();
+    }
 }
@@ -16,16 +16,7 @@ EntityIdList::EntityIdList (std::size_t capacity) : idSlots{}, freeListStart{FRE
 
 phenyl::core::EntityId EntityIdList::newId () {
     if (freeListStart == FREE_LIST_EMPTY) {
-        if (idSlots.size() >= MAX_NUM_IDS) {
-            PHENYL_LOGE(LOGGER, "Too many entity ids!");
-            return EntityId{};
-        }
-        idSlots.push_back(1);
-        numEntities++;
-
-        PHENYL_DASSERT(idSlots.size() < (std::size_t{1} << FREE_LIST_BITS));
-
-        return EntityId{1, static_cast<unsigned int>(idSlots.size())};
+        return appendId();
     } else {
         auto index = freeListStart - 1;
 
@@ -46,6 +37,19 @@ phenyl::core::EntityId EntityIdList::newId () {
     }
 }
 
+phenyl::core::EntityId EntityIdList::appendId () {
+    if (idSlots.size() >= MAX_NUM_IDS) {
+        PHENYL_LOGE(LOGGER, "Too many entity ids!");
+        return EntityId{};
+    }
+    idSlots.push_back(1);
+    numEntities++;
+
+    PHENYL_DASSERT(idSlots.size() < (std::size_t{1} << FREE_LIST_BITS));
+
+    return EntityId{1, static_cast<unsigned int>(idSlots.size())};
+}
+
 bool EntityIdList::check (EntityId id) const {
     if (id.m_id == 0 || id.m_id > idSlots.size()) {
         return false;
@@ -0,0 +1,90 @@
+#include "core/component/detail/sparse_set.h"
+
+using namespace phenyl::core::detail;
+
+SparseComponentSet::SparseComponentSet (IArchetypeManager& manager, std::unique_ptr<UntypedComponentVector> components) :
+    m_manager{manager},
+    m_components{std::move(components)} {}
+
+void SparseComponentSet::make (EntityId id, const IPrefabFactory& factory) {
+    PHENYL_DASSERT(!contains(id));
+    factory.make(insertUntyped(id));
+    onInsert(id);
+}
+
+void SparseComponentSet::erase (EntityId id) {
+    auto i = index(id);
+    if (i == NoIndex) {
+        return;
+    }
+
+    m_manager.onComponentRemove(id, type(), m_components->getUntyped(i));
+
+    // Handlers may have moved the component
+    i = index(id);
+    if (i != NoIndex) {
+        removeIndex(i);
+    }
+}
+
+void SparseComponentSet::remove (EntityId id) {
+    auto i = index(id);
+    if (i != NoIndex) {
+        removeIndex(i);
+    }
+}
+
+void SparseComponentSet::clear () {
+    m_components->clear();
+    m_ids.clear();
+    m_sparse.clear();
+}
+
+void SparseComponentSet::copyFrom (const SparseComponentSet& other) {
+    m_components->copyFrom(*other.m_components);
+    m_ids = other.m_ids;
+    m_sparse = other.m_sparse;
+}
+
+void SparseComponentSet::shrinkToFit () {
+    m_components->shrinkToFit();
+    m_ids.shrink_to_fit();
+
+    // Trailing entities without the component need no slot
+    while (!m_sparse.empty() && m_sparse.back() == NoIndex) {
+        m_sparse.pop_back();
+    }
+    m_sparse.shrink_to_fit();
+}
+
+std::byte* SparseComponentSet::insertUntyped (EntityId id) {
+    auto pos = id.pos();
+    if (pos >= m_sparse.size()) {
+        m_sparse.resize(pos + 1, NoIndex);
+    }
+
+    m_sparse[pos] = static_cast<std::uint32_t>(m_ids.size());
+    m_ids.emplace_back(id);
+    return m_components->insertUntyped();
+}
+
+void SparseComponentSet::onInsert (EntityId id) {
+    auto i = index(id);
+    PHENYL_DASSERT(i != NoIndex);
+
+    m_components->markAdded(i, m_manager.changeTick());
+    m_manager.onComponentInsert(id, type(), m_components->getUntyped(i));
+}
+
+void SparseComponentSet::removeIndex (std::uint32_t index) {
+    PHENYL_DASSERT(index < size());
+
+    // Components are swapped from the back, so the ids must be too
+    m_sparse[m_ids[index].pos()] = NoIndex;
+    m_components->remove(index);
+    if (index != m_ids.size() - 1) {
+        m_ids[index] = m_ids.back();
+        m_sparse[m_ids[index].pos()] = index;
+    }
+    m_ids.pop_back();
+}
@@ -9,9 +9,16 @@ phenyl::Logger Entity::LOGGER{"ENTITY", phenyl::core::detail::COMPONENT_LOGGER};
 
 Entity::Entity (EntityId id, World* entityWorld) : m_id{id}, m_world{entityWorld} {}
 
-const detail::EntityEntry& Entity::entry () const {
+detail::EntityEntry Entity::entry () const {
     PHENYL_DASSERT(exists());
-    return m_world->m_entityEntries[id().pos()];
+    // Entities created during a parallel region have no entry until it ends, which keeps entries safe to read without
+    // locking
+    const auto& entries = m_world->m_entityEntries;
+    return id().pos() < entries.size() ? entries[id().pos()] : detail::EntityEntry{nullptr, 0};
+}
+
+detail::SparseComponentSet* Entity::sparseSet (meta::TypeIndex compType) const noexcept {
+    return m_world->sparseSet(compType);
 }
 
 void Entity::raiseUntyped (meta::TypeIndex signalType, std::byte* ptr) {
@@ -19,19 +26,19 @@ void Entity::raiseUntyped (meta::TypeIndex signalType, std::byte* ptr) {
 }
 
 bool Entity::shouldDefer () {
-    return m_world->m_deferCount;
+    return m_world->isDeferred();
 }
 
-void Entity::deferInsert (meta::TypeIndex compType, std::byte* ptr) {
-    m_world->deferInsert(id(), compType, ptr);
+CommandBuffer& Entity::commands () {
+    return m_world->commandBuffer();
 }
 
-void Entity::deferErase (meta::TypeIndex compType) {
-    m_world->deferErase(id(), compType);
+void Entity::raiseInserts (std::span<const meta::TypeIndex> compTypes) {
+    m_world->raiseInserts(id(), compTypes);
 }
 
-void Entity::deferApply (std::function<void(Entity)> applyFunc) {
-    m_world->deferApply(id(), std::move(applyFunc));
+void Entity::eraseUntyped (std::span<const meta::TypeIndex> compTypes) {
+    m_world->eraseComponents(id(), compTypes);
 }
 
 bool Entity::exists () const noexcept {
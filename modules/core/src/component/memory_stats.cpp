@@ -0,0 +1,95 @@
+#include "core/component/memory_stats.h"
+
+#include "core/world.h"
+
+#include <algorithm>
+
+using namespace phenyl::core;
+
+WorldMemoryStats World::memoryStats () const {
+    auto lock = parallelLock();
+    WorldMemoryStats stats;
+
+    std::unordered_map<meta::TypeIndex, std::size_t> componentIndices;
+    auto addComponent = [&] (meta::TypeIndex type, const ComponentMemoryStats& compStats) {
+        auto [it, inserted] = componentIndices.emplace(type, stats.components.size());
+        if (inserted) {
+            stats.components.emplace_back(compStats);
+            return;
+        }
+
+        auto& total = stats.components[it->second];
+        total.count += compStats.count;
+        total.usedBytes += compStats.usedBytes;
+        total.reservedBytes += compStats.reservedBytes;
+    };
+
+    stats.archetypes.reserve(m_archetypes.size());
+    for (const auto& archetype : m_archetypes) {
+        auto& archStats = stats.archetypes.emplace_back();
+        archStats.entities = archetype->size();
+        archStats.usedBytes = archetype->m_entityIds.size() * sizeof(EntityId);
+        archStats.reservedBytes = archetype->m_entityIds.capacity() * sizeof(EntityId);
+        archStats.edges = archetype->edges();
+
+        for (const auto& [type, vec] : archetype->m_components) {
+            ComponentMemoryStats compStats{
+              .name = componentName(type),
+              .count = vec->size(),
+              .usedBytes = vec->usedBytes(),
+              .reservedBytes = vec->reservedBytes(),
+            };
+            archStats.usedBytes += compStats.usedBytes;
+            archStats.reservedBytes += compStats.reservedBytes;
+            archStats.components.emplace_back(compStats);
+            addComponent(type, compStats);
+        }
+
+        stats.emptyArchetypes += archetype->size() ? 0 : 1;
+        stats.edges += archStats.edges;
+        stats.usedBytes += archStats.usedBytes;
+        stats.reservedBytes += archStats.reservedBytes;
+    }
+
+    for (const auto& [type, set] : m_sparseSets) {
+        ComponentMemoryStats compStats{
+          .name = componentName(type),
+          .count = set->size(),
+          .usedBytes = set->usedBytes(),
+          .reservedBytes = set->reservedBytes(),
+        };
+        addComponent(type, compStats);
+        stats.usedBytes += compStats.usedBytes;
+        stats.reservedBytes += compStats.reservedBytes;
+    }
+    std::ranges::sort(stats.components, {}, &ComponentMemoryStats::name);
+
+    stats.entityUsedBytes = m_entityEntries.size() * sizeof(detail::EntityEntry) + m_idList.usedBytes() +
+        m_relationships.usedBytes();
+    stats.entityReservedBytes = m_entityEntries.capacity() * sizeof(detail::EntityEntry) +
+        m_idList.reservedBytes() + m_relationships.reservedBytes();
+    stats.usedBytes += stats.entityUsedBytes;
+    stats.reservedBytes += stats.entityReservedBytes;
+
+    return stats;
+}
+
+void World::shrinkToFit () {
+    PHENYL_ASSERT_MSG(!m_deferCount && !m_removeDeferCount, "Cannot shrink a deferred world");
+
+    for (const auto& archetype : m_archetypes) {
+        archetype->shrinkToFit();
+    }
+
+    for (auto& [_, set] : m_sparseSets) {
+        set->shrinkToFit();
+    }
+
+    m_entityEntries.shrink_to_fit();
+    m_idList.shrinkToFit();
+    m_relationships.shrinkToFit();
+    m_removedRows.shrink_to_fit();
+    m_deferredRemovals.shrink_to_fit();
+    m_deferredCreations.shrink_to_fit();
+    m_deferredReparents.shrink_to_fit();
+}
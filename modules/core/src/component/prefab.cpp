@@ -84,6 +84,13 @@ void Prefab::instantiate (Entity entity) const {
     ptr->instantiate(m_id, entity);
 }
 
+std::vector<Entity> Prefab::instantiateMany (std::size_t count) const {
+    auto ptr = m_manager.lock();
+    PHENYL_ASSERT_MSG(ptr, "Attempted to create entities with prefab from already deleted PrefabManager!");
+
+    return ptr->instantiateMany(m_id, count);
+}
+
 PrefabManager::PrefabManager (World& world) : m_world{world} {}
 
 Prefab PrefabManager::makePrefab (detail::PrefabFactories factories, std::vector<std::size_t> children) {
@@ -92,11 +99,16 @@ Prefab PrefabManager::makePrefab (detail::PrefabFactories factories, std::vector
     }
 
     auto id = m_nextPrefabId++;
+    detail::ArchetypeKey key{factories | std::ranges::views::keys};
     m_entries.emplace(id,
         PrefabEntry{
           .factories = std::move(factories),
           .childEntries = std::move(children),
           .refCount = 1,
+          .key = std::move(key),
+          .sparseFactories = {},
+          .archetype = nullptr,
+          .layout = {},
         });
 
     return Prefab{id, weak_from_this()};
@@ -130,17 +142,90 @@ void PrefabManager::instantiate (std::size_t prefabId, Entity entity) {
     PHENYL_DASSERT(m_entries.contains(prefabId));
 
     if (m_deferring) {
+        auto lock = m_world.parallelLock();
         m_deferredInstantiations.emplace_back(entity.id(), prefabId);
         incrementRefCount(prefabId); // So prefab doesnt get deleted while deferring
         return;
     }
 
-    const auto& entry = m_entries[prefabId];
-    m_world.instantiatePrefab(entity.id(), entry.factories);
+    const auto& entry = compile(prefabId);
+    m_world.instantiatePrefab(entity.id(), entry);
+
+    // Children are new entities, so can be built straight into their archetypes
+    std::vector<EntityId> ids(entry.layout.size());
+    ids[0] = entity.id();
+    m_world.reserveIds(std::span{ids}.subspan(1));
+    for (std::size_t i = 1; i < entry.layout.size(); i++) {
+        auto [child, parentIndex] = entry.layout[i];
+        m_world.spawnPrefabRows(std::span{ids}.subspan(i, 1), std::span{ids}.subspan(parentIndex, 1), *child);
+    }
+}
+
+std::vector<Entity> PrefabManager::instantiateMany (std::size_t prefabId, std::size_t count) {
+    PHENYL_DASSERT(m_entries.contains(prefabId));
+
+    std::vector<Entity> roots;
+    roots.reserve(count);
+    if (m_deferring) {
+        for (std::size_t i = 0; i < count; i++) {
+            auto entity = m_world.create();
+            instantiate(prefabId, entity);
+            roots.emplace_back(entity);
+        }
 
-    for (auto i : entry.childEntries) {
-        instantiate(i, m_world.create(entity.id()));
+        return roots;
     }
+
+    const auto& entry = compile(prefabId);
+
+    // Ids of every entity in the hierarchy, grouped by position in the layout
+    std::vector<EntityId> ids(entry.layout.size() * count);
+    m_world.reserveIds(ids);
+
+    for (std::size_t i = 0; i < entry.layout.size(); i++) {
+        auto [node, parentIndex] = entry.layout[i];
+        auto nodeIds = std::span{ids}.subspan(i * count, count);
+        if (i) {
+            m_world.spawnPrefabRows(nodeIds, std::span{ids}.subspan(parentIndex * count, count), *node);
+        } else {
+            m_world.spawnPrefabRows(nodeIds, {}, *node);
+        }
+    }
+
+    for (auto id : std::span{ids}.subspan(0, count)) {
+        roots.emplace_back(m_world.entity(id));
+    }
+    return roots;
+}
+
+PrefabEntry& PrefabManager::compile (std::size_t prefabId) {
+    auto& entry = m_entries[prefabId];
+    if (entry.archetype) {
+        return entry;
+    }
+
+    // Sparse set components are not part of the archetype
+    for (auto it = entry.factories.begin(); it != entry.factories.end();) {
+        if (m_world.sparseSet(it->first)) {
+            entry.sparseFactories.insert(entry.factories.extract(it++));
+        } else {
+            ++it;
+        }
+    }
+    if (!entry.sparseFactories.empty()) {
+        entry.key = detail::ArchetypeKey{entry.factories | std::ranges::views::keys};
+    }
+
+    entry.archetype = m_world.findArchetype(entry.key);
+    entry.layout.clear();
+    entry.layout.emplace_back(&entry, 0);
+    for (std::size_t i = 0; i < entry.layout.size(); i++) {
+        for (auto childId : entry.layout[i].first->childEntries) {
+            entry.layout.emplace_back(&compile(childId), i);
+        }
+    }
+
+    return entry;
 }
 
 void PrefabManager::defer () {
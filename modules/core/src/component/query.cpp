@@ -4,12 +4,17 @@
 
 using namespace phenyl::core;
 
-QueryArchetypes::QueryArchetypes (World& world, detail::QueryKey key) : m_world{world}, m_key{std::move(key)} {}
+QueryArchetypes::QueryArchetypes (World& world, detail::QueryKey key, std::size_t id) :
+    m_world{world},
+    m_key{std::move(key)},
+    m_id{id} {}
 
 void QueryArchetypes::onNewArchetype (Archetype* archetype) {
-    if (m_key.isSatisfied(archetype)) {
+    auto matches = m_key.isSatisfied(archetype);
+    archetype->markQuery(m_id, matches);
+    if (matches) {
         // All components found
-        m_archetypes.emplace(archetype);
+        m_archetypes.emplace_back(archetype);
     }
 }
 
@@ -21,9 +26,32 @@ void QueryArchetypes::unlock () {
     m_world.deferEnd();
 }
 
-detail::QueryKey::QueryKey (ArchetypeKey archKey, std::vector<meta::TypeIndex> interfaces) :
+std::uint32_t QueryArchetypes::changeTick () const noexcept {
+    return m_world.changeTick();
+}
+
+std::uint32_t QueryArchetypes::advanceChangeTick () {
+    return m_world.advanceChangeTick();
+}
+
+const std::vector<detail::HierarchyEntry>& QueryArchetypes::hierarchy () {
+    auto lock = m_world.parallelLock();
+    return m_world.m_relationships.hierarchy();
+}
+
+std::uint32_t QueryArchetypes::hierarchyIndex (EntityId id) const {
+    return m_world.m_relationships.hierarchyIndex(id);
+}
+
+void QueryArchetypes::parallelFor (std::size_t numTasks, const std::function<void(std::size_t)>& task) {
+    m_world.runParallel(numTasks, task);
+}
+
+detail::QueryKey::QueryKey (ArchetypeKey archKey, std::vector<meta::TypeIndex> interfaces,
+    std::vector<meta::TypeIndex> sparse) :
     m_archKey{std::move(archKey)},
-    m_interfaces{std::move(interfaces)} {}
+    m_interfaces{std::move(interfaces)},
+    m_sparse{std::move(sparse)} {}
 
 bool detail::QueryKey::isSatisfied (const Archetype* archetype) {
     if (!archetype->getKey().subsetOf(m_archKey)) {
@@ -35,9 +63,47 @@ bool detail::QueryKey::isSatisfied (const Archetype* archetype) {
 
 bool detail::QueryKey::operator== (const QueryKey& other) const = default;
 
+detail::ChangeFilterView::ChangeFilterView (const Archetype& archetype, std::span<const ChangeFilter> filters,
+    std::uint32_t lastRun) :
+    m_lastRun{lastRun} {
+    m_ticks.reserve(filters.size());
+    for (const auto& [type, added, _] : filters) {
+        auto* vec = archetype.tryGetVector(type);
+        PHENYL_DASSERT(vec);
+        m_ticks.emplace_back(added ? vec->addedTicks() : vec->changedTicks());
+    }
+}
+
+bool detail::ChangeFilterView::MatchesRow (const Archetype& archetype, std::size_t pos, EntityId id,
+    std::span<const ChangeFilter> filters, std::uint32_t lastRun) {
+    for (const auto& [type, added, sparse] : filters) {
+        const auto* vec = sparse ? &sparse->components() : archetype.tryGetVector(type);
+        auto row = sparse ? sparse->index(id) : pos;
+        PHENYL_DASSERT(vec);
+        PHENYL_DASSERT(row < vec->size());
+
+        if (!TickNewer(added ? vec->addedTick(row) : vec->changedTick(row), lastRun)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 QueryArchetypes::Iterator::Iterator () = default;
 
-QueryArchetypes::Iterator::Iterator (std::unordered_set<Archetype*>::const_iterator it) : m_it{it} {}
+QueryArchetypes::Iterator::Iterator (std::vector<Archetype*>::const_iterator it,
+    std::vector<Archetype*>::const_iterator end) :
+    m_it{it},
+    m_end{end} {
+    skipEmpty();
+}
+
+void QueryArchetypes::Iterator::skipEmpty () {
+    while (m_it != m_end && !(*m_it)->size()) {
+        ++m_it;
+    }
+}
 
 QueryArchetypes::Iterator::reference QueryArchetypes::Iterator::operator* () const {
     return **m_it;
@@ -45,6 +111,7 @@ QueryArchetypes::Iterator::reference QueryArchetypes::Iterator::operator* () con
 
 QueryArchetypes::Iterator& QueryArchetypes::Iterator::operator++ () {
     ++m_it;
+    skipEmpty();
     return *this;
 }
 
@@ -0,0 +1,157 @@
+#include "core/component/world_snapshot.h"
+
+#include "core/world.h"
+
+using namespace phenyl::core;
+
+std::size_t WorldSnapshot::memoryUsage () const noexcept {
+    std::size_t total = 0;
+    for (const auto& state : m_archetypes) {
+        total += state.ids.capacity() * sizeof(EntityId);
+        for (const auto& column : state.columns) {
+            total += column->reservedBytes() / static_cast<std::size_t>(column.use_count());
+        }
+    }
+
+    for (const auto& [_, set] : m_sparseSets) {
+        total += set->reservedBytes();
+    }
+
+    if (m_entities) {
+        total += (m_entities->entries.capacity() * sizeof(detail::EntityEntry) + m_entities->idList.reservedBytes() +
+                     m_entities->relationships.reservedBytes()) /
+            static_cast<std::size_t>(m_entities.use_count());
+    }
+    return total;
+}
+
+void World::snapshot (WorldSnapshot& snapshot) {
+    snapshotInto(snapshot, nullptr);
+}
+
+void World::snapshot (WorldSnapshot& snapshot, const WorldSnapshot& base) {
+    PHENYL_ASSERT_MSG(base.m_world == this, "Attempted to take a snapshot against a base of another world");
+    PHENYL_ASSERT(&snapshot != &base);
+    snapshotInto(snapshot, &base);
+}
+
+WorldSnapshot World::snapshot () {
+    WorldSnapshot result;
+    snapshotInto(result, nullptr);
+    return result;
+}
+
+void World::restore (const WorldSnapshot& snapshot) {
+    PHENYL_ASSERT_MSG(snapshot.m_world == this, "Attempted to restore a snapshot of another world");
+    PHENYL_ASSERT_MSG(!m_deferCount && !m_removeDeferCount, "Cannot restore a snapshot into a deferred world");
+
+    auto tick = changeTick();
+    for (std::size_t i = 0; i < m_archetypes.size(); i++) {
+        auto& archetype = *m_archetypes[i];
+        if (i >= snapshot.m_archetypes.size()) {
+            archetype.clear();
+            continue;
+        }
+
+        const auto& state = snapshot.m_archetypes[i];
+        PHENYL_DASSERT(state.columns.size() == archetype.m_components.size());
+        archetype.m_entityIds.assign(state.ids.begin(), state.ids.end());
+
+        auto column = state.columns.begin();
+        for (auto& [_, vec] : archetype.m_components) {
+            vec->copyFrom(**column++);
+            vec->markAllChanged(tick);
+        }
+    }
+
+    for (auto& [type, set] : m_sparseSets) {
+        auto it = std::ranges::find(snapshot.m_sparseSets, type, [] (const auto& p) { return p.first; });
+        if (it == snapshot.m_sparseSets.end()) {
+            set->clear();
+            continue;
+        }
+
+        set->copyFrom(*it->second);
+        set->markAllChanged(tick);
+    }
+
+    // Entries point to archetypes, which outlive the snapshot
+    m_entityEntries = snapshot.m_entities->entries;
+    m_idList = snapshot.m_entities->idList;
+    m_relationships = snapshot.m_entities->relationships;
+}
+
+void World::snapshotInto (WorldSnapshot& snapshot, const WorldSnapshot* base) {
+    PHENYL_ASSERT_MSG(!m_deferCount && !m_removeDeferCount, "Cannot take a snapshot of a deferred world");
+    if (snapshot.m_world != this) {
+        snapshot = WorldSnapshot{};
+        snapshot.m_world = this;
+    }
+    if (base && changeTick() - base->m_tick >= detail::MaxTickAge) {
+        // Ticks this old may have been clamped since, so cannot tell which rows are unchanged
+        base = nullptr;
+    }
+
+    // Rows changed from here on are stamped with a later tick, so later snapshots can tell what is unchanged
+    snapshot.m_tick = advanceChangeTick();
+
+    // Archetypes are never destroyed, so the snapshot only ever has to catch up with new ones
+    snapshot.m_archetypes.resize(m_archetypes.size());
+    for (std::size_t i = 0; i < m_archetypes.size(); i++) {
+        const auto& archetype = *m_archetypes[i];
+        auto& state = snapshot.m_archetypes[i];
+        state.columns.resize(archetype.m_components.size());
+
+        // Columns can only be shared if the rows still hold the same entities
+        const auto* baseState = base && i < base->m_archetypes.size() ? &base->m_archetypes[i] : nullptr;
+        if (baseState && !std::ranges::equal(baseState->ids, archetype.m_entityIds)) {
+            baseState = nullptr;
+        }
+        state.ids.assign(archetype.m_entityIds.begin(), archetype.m_entityIds.end());
+
+        std::size_t index = 0;
+        for (const auto& [type, vec] : archetype.m_components) {
+            auto& column = state.columns[index];
+            if (baseState && !vec->changedSince(base->m_tick)) {
+                column = baseState->columns[index++];
+                continue;
+            }
+
+            // Columns still shared with other snapshots are left to them
+            if (!column || column.use_count() > 1) {
+                PHENYL_ASSERT_MSG(vec->copyable(), "Cannot take a snapshot of non-copyable component \"{}\"",
+                    componentName(type));
+                column = vec->makeNew(archetype.size());
+            }
+            column->copyFrom(*vec);
+            index++;
+        }
+    }
+
+    for (const auto& [type, set] : m_sparseSets) {
+        auto it = std::ranges::find(snapshot.m_sparseSets, type, [] (const auto& p) { return p.first; });
+        if (it == snapshot.m_sparseSets.end()) {
+            PHENYL_ASSERT_MSG(set->components().copyable(), "Cannot take a snapshot of non-copyable component \"{}\"",
+                componentName(type));
+            snapshot.m_sparseSets.emplace_back(type,
+                std::make_unique<detail::SparseComponentSet>(static_cast<detail::IArchetypeManager&>(*this),
+                    set->components().makeNew(set->size())));
+            it = snapshot.m_sparseSets.end() - 1;
+        }
+        it->second->copyFrom(*set);
+    }
+
+    const auto& baseEntities = base ? base->m_entities : nullptr;
+    if (baseEntities && baseEntities->entries == m_entityEntries && baseEntities->idList == m_idList &&
+        baseEntities->relationships == m_relationships) {
+        snapshot.m_entities = baseEntities;
+        return;
+    }
+
+    if (!snapshot.m_entities || snapshot.m_entities.use_count() > 1) {
+        snapshot.m_entities = std::make_shared<WorldSnapshot::Entities>();
+    }
+    snapshot.m_entities->entries = m_entityEntries;
+    snapshot.m_entities->idList = m_idList;
+    snapshot.m_entities->relationships = m_relationships;
+}
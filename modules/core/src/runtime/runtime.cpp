@@ -18,8 +18,15 @@ void ResourceManager::registerResource (meta::TypeIndex typeIndex, IResource* re
     PHENYL_LOGI(LOGGER, "Registered resource \"{}\"", resource->getName());
 }
 
+std::string_view ResourceManager::resourceName (meta::TypeIndex type) const noexcept {
+    auto it = m_resources.find(type);
+    return it != m_resources.end() ? it->second->getName() : std::string_view{};
+}
+
 PhenylRuntime::PhenylRuntime () : m_world{} {
     PHENYL_LOGI(LOGGER, "Initialised Phenyl runtime");
+    addResource(&m_stats);
+
     initStage<PostInit>("PostInit");
     initStage<FrameBegin>("FrameBegin");
     initStage<GlobalFixedTimestep>("GlobalFixedTimestep");
@@ -61,12 +68,18 @@ void PhenylRuntime::registerPlugin (meta::TypeIndex typeIndex, IInitPlugin& plug
     PHENYL_LOGI(LOGGER, "Registered plugin \"{}\"", plugin.getName());
 }
 
+void PhenylRuntime::addFixedTimestepCallback (std::function<void()> callback) {
+    m_fixedTimestepCallbacks.emplace_back(std::move(callback));
+}
+
 void PhenylRuntime::runPostInit () {
     PHENYL_TRACE(LOGGER, "Initiating PostInit stage");
     getStage<PostInit>()->run();
 }
 
 void PhenylRuntime::runFrameBegin () {
+    m_stats.signalsDispatched = m_world.takeDispatchedSignals();
+
     PHENYL_TRACE(LOGGER, "Initiating FrameBegin stage");
     getStage<FrameBegin>()->run();
 }
@@ -74,6 +87,10 @@ void PhenylRuntime::runFrameBegin () {
 void PhenylRuntime::runFixedTimestep () {
     PHENYL_TRACE(LOGGER, "Initiating GlobalFixedTimestep stage");
     getStage<GlobalFixedTimestep>()->run();
+
+    for (const auto& callback : m_fixedTimestepCallbacks) {
+        callback();
+    }
 }
 
 void PhenylRuntime::runVariableTimestep () {
@@ -112,3 +129,7 @@ const std::vector<ComponentInfo>& PhenylRuntime::components () const noexcept {
 const std::vector<std::string>& PhenylRuntime::plugins () const noexcept {
     return m_pluginNames;
 }
+
+WorldMemoryStats PhenylRuntime::memoryStats () const {
+    return m_world.memoryStats();
+}
@@ -2,9 +2,20 @@
 #include "core/runtime/stage.h"
 #include "core/runtime/system.h"
 #include "util/random.h"
+#include "util/trace.h"
+
+#include <format>
+#include <unordered_map>
 
 using namespace phenyl::core;
 
+static phenyl::Logger LOGGER{"STAGE", phenyl::PHENYL_LOGGER};
+
+static void RunSystem (IRunnableSystem* system, PhenylRuntime& runtime) {
+    phenyl::util::TraceZone zone{"system", system->getName()};
+    system->run(runtime);
+}
+
 AbstractStage::AbstractStage (std::string name, PhenylRuntime& runtime) : m_name{std::move(name)}, m_runtime{runtime} {}
 
 AbstractStage::~AbstractStage () = default;
@@ -16,23 +27,19 @@ void AbstractStage::addSystemUntyped (IRunnableSystem* system) {
 }
 
 void AbstractStage::run () {
+    util::TraceZone zone{"stage", m_name};
     if (m_updated) {
         orderSystems();
         orderStages();
+        scheduleSystems();
         m_updated = false;
+
+        PHENYL_LOGD(LOGGER, "{}", scheduleDump());
     }
 
     m_runtime.world().defer();
-    for (auto* i : m_orderedSystems) {
-        if (i->exclusive()) {
-            m_runtime.world().deferEnd();
-        }
-
-        i->run(m_runtime);
-
-        if (i->exclusive()) {
-            m_runtime.world().defer();
-        }
+    for (auto& batch : m_batches) {
+        runBatch(batch);
     }
     m_runtime.world().deferEnd();
 
@@ -41,6 +48,23 @@ void AbstractStage::run () {
     }
 }
 
+std::string AbstractStage::scheduleDump () const {
+    auto dump = std::format("Stage \"{}\": {} systems in {} batches", m_name, m_orderedSystems.size(),
+        m_batches.size());
+    for (std::size_t i = 0; i < m_batches.size(); i++) {
+        const auto& batch = m_batches[i];
+        dump += std::format("\n  Batch {}{}:", i, batch.exclusive ? " (exclusive)" : "");
+        for (std::size_t j = 0; j < batch.systems.size(); j++) {
+            dump += std::format("\n    {}", batch.systems[j]->getName());
+            if (!batch.reasons[j].empty()) {
+                dump += std::format(" ({})", batch.reasons[j]);
+            }
+        }
+    }
+
+    return dump;
+}
+
 void AbstractStage::addChildStage (AbstractStage* stage) {
     PHENYL_DASSERT(stage);
     m_childStages.emplace_back(stage);
@@ -69,6 +93,90 @@ void AbstractStage::orderSystems () {
     }
 }
 
+void AbstractStage::scheduleSystems () {
+    m_batches.clear();
+
+    std::unordered_map<IRunnableSystem*, std::size_t> systemBatches;
+    // Resolved so that accesses to an interface conflict with accesses to its implementors
+    std::unordered_map<IRunnableSystem*, SystemAccess> accesses;
+    // Systems cannot be moved before the last exclusive batch
+    std::size_t firstBatch = 0;
+    for (auto* system : m_orderedSystems) {
+        const auto* access = system->access();
+        if (system->exclusive() || !access) {
+            systemBatches.emplace(system, m_batches.size());
+            m_batches.push_back(SystemBatch{
+              .systems = {system},
+              .reasons = {system->exclusive() ? "exclusive" : "no declared access"},
+              .exclusive = true,
+            });
+            firstBatch = m_batches.size();
+            continue;
+        }
+
+        const auto& resolved = accesses.emplace(system, access->resolveInterfaces(m_runtime.world())).first->second;
+        auto batchIndex = firstBatch;
+        std::string reason = firstBatch ?
+            std::format("runs after exclusive {}", m_batches[firstBatch - 1].systems.front()->getName()) :
+            std::string{};
+        for (auto* prev : system->getPrecedingSystems()) {
+            auto it = systemBatches.find(prev);
+            if (it != systemBatches.end() && it->second >= batchIndex) {
+                batchIndex = it->second + 1;
+                reason = std::format("runs after {}", prev->getName());
+            }
+        }
+
+        // Conflicting systems keep their topological order
+        for (auto i = batchIndex; i < m_batches.size(); i++) {
+            for (auto* other : m_batches[i].systems) {
+                auto conflict = resolved.conflict(accesses.at(other));
+                if (!conflict) {
+                    continue;
+                }
+
+                auto typeName = conflict->isResource ? m_runtime.resources().resourceName(conflict->type) :
+                                                       m_runtime.world().componentName(conflict->type);
+                batchIndex = i + 1;
+                reason = std::format("conflicts with {} on {} {}", other->getName(),
+                    conflict->isResource ? "resource" : "component",
+                    typeName.empty() ? std::format("#{}", conflict->type) : std::string{typeName});
+                break;
+            }
+        }
+
+        if (batchIndex == m_batches.size()) {
+            m_batches.emplace_back();
+        }
+        m_batches[batchIndex].systems.emplace_back(system);
+        m_batches[batchIndex].reasons.emplace_back(std::move(reason));
+        systemBatches.emplace(system, batchIndex);
+    }
+}
+
+void AbstractStage::runBatch (SystemBatch& batch) {
+    auto& world = m_runtime.world();
+    if (batch.exclusive || !m_parallel) {
+        // Serial systems run undeferred, so each sees the structural changes of the ones before it
+        world.deferEnd();
+        for (auto* i : batch.systems) {
+            RunSystem(i, m_runtime);
+        }
+        world.defer();
+        return;
+    }
+
+    if (batch.systems.size() == 1) {
+        RunSystem(batch.systems.front(), m_runtime);
+    } else {
+        world.runParallel(batch.systems.size(), [&] (std::size_t i) { RunSystem(batch.systems[i], m_runtime); });
+    }
+
+    // Apply structural changes before later batches run
+    world.deferEnd();
+    world.defer();
+}
+
 void AbstractStage::orderStages () {
     std::vector<AbstractStage*> stages = m_childStages;
     m_childStages.clear();
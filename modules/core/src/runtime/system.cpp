@@ -0,0 +1,90 @@
+#include "core/runtime.h"
+#include "core/runtime/system.h"
+
+#include <algorithm>
+
+using namespace phenyl::core;
+
+namespace {
+using AccessList = std::vector<std::pair<phenyl::meta::TypeIndex, bool>>;
+
+std::optional<phenyl::meta::TypeIndex> FindConflict (const AccessList& lhs, const AccessList& rhs) {
+    // Both lists are sorted by type, so walk them together
+    auto lhsIt = lhs.begin();
+    auto rhsIt = rhs.begin();
+    while (lhsIt != lhs.end() && rhsIt != rhs.end()) {
+        if (lhsIt->first < rhsIt->first) {
+            ++lhsIt;
+        } else if (rhsIt->first < lhsIt->first) {
+            ++rhsIt;
+        } else {
+            if (lhsIt->second || rhsIt->second) {
+                return lhsIt->first;
+            }
+            ++lhsIt;
+            ++rhsIt;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<bool> FindAccess (const AccessList& accesses, phenyl::meta::TypeIndex type) {
+    auto it = std::ranges::lower_bound(accesses, type, {}, &AccessList::value_type::first);
+    if (it == accesses.end() || it->first != type) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+} // namespace
+
+std::optional<SystemAccess::Conflict> SystemAccess::conflict (const SystemAccess& other) const {
+    if (auto type = FindConflict(m_components, other.m_components)) {
+        return Conflict{.type = *type, .isResource = false};
+    }
+
+    if (auto type = FindConflict(m_resources, other.m_resources)) {
+        return Conflict{.type = *type, .isResource = true};
+    }
+
+    return std::nullopt;
+}
+
+SystemAccess& SystemAccess::merge (const SystemAccess& other) {
+    for (auto [type, write] : other.m_components) {
+        addAccess(m_components, type, write);
+    }
+    for (auto [type, write] : other.m_resources) {
+        addAccess(m_resources, type, write);
+    }
+    return *this;
+}
+
+SystemAccess SystemAccess::resolveInterfaces (const World& world) const {
+    auto resolved = *this;
+    for (auto [type, write] : m_components) {
+        for (auto implementor : world.interfaceImplementors(type)) {
+            addAccess(resolved.m_components, implementor, write);
+        }
+    }
+    return resolved;
+}
+
+std::optional<bool> SystemAccess::componentAccess (meta::TypeIndex type) const {
+    return FindAccess(m_components, type);
+}
+
+std::optional<bool> SystemAccess::resourceAccess (meta::TypeIndex type) const {
+    return FindAccess(m_resources, type);
+}
+
+void SystemAccess::addAccess (AccessList& accesses, meta::TypeIndex type, bool write) {
+    auto it = std::ranges::lower_bound(accesses, type, {}, &AccessList::value_type::first);
+    if (it != accesses.end() && it->first == type) {
+        // Writes win over reads
+        it->second = it->second || write;
+    } else {
+        accesses.emplace(it, type, write);
+    }
+}
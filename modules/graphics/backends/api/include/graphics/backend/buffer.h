@@ -1,6 +1,7 @@
 #pragma once
 
 #include "logging/logging.h"
+#include "resource_lock.h"
 
 #include <memory>
 #include <vector>
@@ -23,7 +24,7 @@ class Buffer {
 public:
     Buffer () : m_buffer{}, m_data{} {}
 
-    explicit Buffer (std::unique_ptr<IBuffer> rendererBuffer) : m_buffer{std::move(rendererBuffer)}, m_data{} {}
+    explicit Buffer (detail::LockedPtr<IBuffer> rendererBuffer) : m_buffer{std::move(rendererBuffer)}, m_data{} {}
 
     explicit operator bool () const {
         return (bool) m_buffer;
@@ -56,6 +57,7 @@ public:
     }
 
     void upload () {
+        auto lock = detail::LockResource(m_buffer);
         m_buffer->upload(std::as_bytes(std::span{m_data}));
     }
 
@@ -70,7 +72,7 @@ public:
     }
 
 private:
-    std::unique_ptr<IBuffer> m_buffer;
+    detail::LockedPtr<IBuffer> m_buffer;
     std::vector<T> m_data;
 };
 
@@ -78,7 +80,7 @@ class RawBuffer {
 public:
     RawBuffer () = default;
 
-    explicit RawBuffer (std::unique_ptr<IBuffer> rendererBuffer) : m_buffer{std::move(rendererBuffer)} {}
+    explicit RawBuffer (detail::LockedPtr<IBuffer> rendererBuffer) : m_buffer{std::move(rendererBuffer)} {}
 
     RawBuffer (const RawBuffer&) = delete;
     RawBuffer (RawBuffer&&) = default;
@@ -91,6 +93,7 @@ public:
     }
 
     void upload (std::span<const std::byte> data) {
+        auto lock = detail::LockResource(m_buffer);
         m_buffer->upload(data);
         this->m_size = data.size();
     }
@@ -110,7 +113,7 @@ public:
     }
 
 private:
-    std::unique_ptr<IBuffer> m_buffer;
+    detail::LockedPtr<IBuffer> m_buffer;
     std::size_t m_size = 0;
 };
 } // namespace phenyl::graphics
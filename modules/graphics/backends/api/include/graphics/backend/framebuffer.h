@@ -34,7 +34,7 @@ class FrameBuffer {
 public:
     FrameBuffer () : m_framebuffer{nullptr} {}
 
-    explicit FrameBuffer (std::unique_ptr<IFrameBuffer> fb) : m_framebuffer{std::move(fb)} {}
+    explicit FrameBuffer (detail::LockedPtr<IFrameBuffer> fb) : m_framebuffer{std::move(fb)} {}
 
     IFrameBuffer& getUnderlying () noexcept {
         PHENYL_DASSERT(m_framebuffer);
@@ -73,10 +73,11 @@ public:
 
     void clear (glm::vec4 clearColor = {0.0f, 0.0f, 0.0f, 1.0f}) {
         PHENYL_DASSERT(m_framebuffer);
+        auto lock = detail::LockResource(m_framebuffer);
         m_framebuffer->clear(clearColor);
     }
 
 private:
-    std::unique_ptr<IFrameBuffer> m_framebuffer;
+    detail::LockedPtr<IFrameBuffer> m_framebuffer;
 };
 } // namespace phenyl::graphics
@@ -88,7 +88,7 @@ class Pipeline {
 public:
     Pipeline () = default;
 
-    explicit Pipeline (std::unique_ptr<IPipeline> underlying) : m_pipeline{std::move(underlying)} {}
+    explicit Pipeline (detail::LockedPtr<IPipeline> underlying) : m_pipeline{std::move(underlying)} {}
 
     explicit operator bool () const {
         return static_cast<bool>(m_pipeline);
@@ -191,7 +191,7 @@ public:
     }
 
 private:
-    std::unique_ptr<IPipeline> m_pipeline;
+    detail::LockedPtr<IPipeline> m_pipeline;
 };
 
 class IPipelineBuilder {
@@ -215,7 +215,9 @@ public:
 
 class PipelineBuilder {
 public:
-    explicit PipelineBuilder (std::unique_ptr<IPipelineBuilder> builder) : m_builder{std::move(builder)} {}
+    PipelineBuilder (std::unique_ptr<IPipelineBuilder> builder, ResourceMutex& mutex) :
+        m_builder{std::move(builder)},
+        m_mutex{&mutex} {}
 
     PipelineBuilder& withGeometryType (GeometryType type) {
         PHENYL_DASSERT(m_builder);
@@ -309,10 +311,12 @@ public:
     Pipeline build () {
         PHENYL_DASSERT(m_builder);
 
-        return Pipeline{m_builder->build()};
+        auto lock = detail::LockResource(m_mutex);
+        return Pipeline{detail::MakeLocked(m_builder->build(), *m_mutex)};
     }
 
 private:
     std::unique_ptr<IPipelineBuilder> m_builder;
+    ResourceMutex* m_mutex;
 };
 } // namespace phenyl::graphics
@@ -13,6 +13,7 @@
 #include "uniform_buffer.h"
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <vector>
 
@@ -32,43 +33,63 @@ public:
 
     virtual void finishRender () = 0;
 
-    virtual PipelineBuilder buildPipeline () = 0;
+    PipelineBuilder buildPipeline () {
+        return PipelineBuilder{makeRendererPipelineBuilder(), m_resourceMutex};
+    }
 
     virtual void loadDefaultShaders () = 0;
 
     virtual Viewport& getViewport () = 0;
     virtual const Viewport& getViewport () const = 0;
 
+    // Held while a frame is rendered. Resource handles made by the renderer take it to be created, uploaded to or
+    // destroyed, so with pipelined rendering they wait for a frame rendering on another thread. Anything else touching
+    // the backend outside of the Render stage must be done under it
+    [[nodiscard]] std::unique_lock<ResourceMutex> lockResources () {
+        return std::unique_lock{m_resourceMutex};
+    }
+
     template <typename T>
     Buffer<T> makeBuffer (std::size_t capacity, BufferStorageHint storageHint, bool isIndex = false) {
-        return Buffer<T>(makeRendererBuffer(sizeof(T) * capacity, sizeof(T), storageHint, isIndex));
+        auto lock = lockResources();
+        auto buffer = makeRendererBuffer(sizeof(T) * capacity, sizeof(T), storageHint, isIndex);
+        return Buffer<T>(detail::MakeLocked(std::move(buffer), m_resourceMutex));
     }
 
     RawBuffer makeRawBuffer (std::size_t stride, std::size_t capacity, BufferStorageHint storageHint,
         bool isIndex = false) {
-        return RawBuffer{makeRendererBuffer(capacity * stride, stride, storageHint, isIndex)};
+        auto lock = lockResources();
+        auto buffer = makeRendererBuffer(capacity * stride, stride, storageHint, isIndex);
+        return RawBuffer{detail::MakeLocked(std::move(buffer), m_resourceMutex)};
     }
 
     template <typename T, typename... Args>
     UniformBuffer<T> makeUniformBuffer (bool readable, Args&&... args) {
-        return UniformBuffer<T>(makeRendererUniformBuffer(readable), std::forward<Args>(args)...);
+        auto lock = lockResources();
+        return UniformBuffer<T>(detail::MakeLocked(makeRendererUniformBuffer(readable), m_resourceMutex),
+            std::forward<Args>(args)...);
     }
 
     template <typename T, typename... Args>
     UniformBuffer<T> makeUniformBuffer (Args&&... args) {
-        return UniformBuffer<T>(makeRendererUniformBuffer(false), std::forward<Args>(args)...);
+        auto lock = lockResources();
+        return UniformBuffer<T>(detail::MakeLocked(makeRendererUniformBuffer(false), m_resourceMutex),
+            std::forward<Args>(args)...);
     }
 
     template <typename T>
     UniformArrayBuffer<T> makeUniformArrayBuffer (std::size_t capacity = 8) {
-        return UniformArrayBuffer<T>(makeRendererUniformBuffer(false), capacity);
+        auto lock = lockResources();
+        return UniformArrayBuffer<T>(detail::MakeLocked(makeRendererUniformBuffer(false), m_resourceMutex), capacity);
     }
 
     RawUniformBuffer makeRawUniformBuffer (std::size_t size, bool readable = false) {
-        return RawUniformBuffer{makeRendererUniformBuffer(readable), size};
+        auto lock = lockResources();
+        return RawUniformBuffer{detail::MakeLocked(makeRendererUniformBuffer(readable), m_resourceMutex), size};
     }
 
     ImageTexture makeTexture (const TextureProperties& properties, const Image& image) {
+        auto lock = lockResources();
         auto texture = makeImageTexture(properties);
         texture.upload(image);
 
@@ -76,16 +97,20 @@ public:
     }
 
     ImageTexture makeImageTexture (const TextureProperties& properties) {
-        return ImageTexture{makeRendererImageTexture(properties)};
+        auto lock = lockResources();
+        return ImageTexture{detail::MakeLocked(makeRendererImageTexture(properties), m_resourceMutex)};
     }
 
     ImageArrayTexture makeArrayTexture (const TextureProperties& properties, std::uint32_t width,
         std::uint32_t height) {
-        return ImageArrayTexture{makeRendererArrayTexture(properties, width, height)};
+        auto lock = lockResources();
+        auto texture = makeRendererArrayTexture(properties, width, height);
+        return ImageArrayTexture{detail::MakeLocked(std::move(texture), m_resourceMutex)};
     }
 
     FrameBuffer makeFrameBuffer (const FrameBufferProperties& properties, std::uint32_t width, std::uint32_t height) {
-        return FrameBuffer{makeRendererFrameBuffer(properties, width, height)};
+        auto lock = lockResources();
+        return FrameBuffer{detail::MakeLocked(makeRendererFrameBuffer(properties, width, height), m_resourceMutex)};
     }
 
     CommandList getCommandList () {
@@ -116,6 +141,7 @@ public:
     virtual void render () = 0;
 
 protected:
+    virtual std::unique_ptr<IPipelineBuilder> makeRendererPipelineBuilder () = 0;
     virtual std::unique_ptr<IBuffer> makeRendererBuffer (std::size_t startCapacity, std::size_t elementSize,
         BufferStorageHint storageHint, bool isIndex) = 0;
     virtual std::unique_ptr<IUniformBuffer> makeRendererUniformBuffer (bool readable) = 0;
@@ -134,8 +160,11 @@ protected:
 
 private:
     std::vector<std::unique_ptr<AbstractRenderLayer>> m_layers;
+    ResourceMutex m_resourceMutex;
 };
 
 std::unique_ptr<Renderer> MakeGLRenderer (const GraphicsProperties& properties);
 std::unique_ptr<Renderer> MakeVulkanRenderer (const GraphicsProperties& properties);
+// Renderer with no window or GPU behind it, for running without graphics
+std::unique_ptr<Renderer> MakeHeadlessRenderer (const GraphicsProperties& properties);
 } // namespace phenyl::graphics
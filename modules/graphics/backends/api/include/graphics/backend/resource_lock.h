@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+namespace phenyl::graphics {
+// Renderer lock that resource handles take to upload to or destroy their backend resource, so they stay consistent
+// with a frame rendering on another thread
+using ResourceMutex = std::recursive_mutex;
+
+namespace detail {
+    inline std::unique_lock<ResourceMutex> LockResource (ResourceMutex* mutex) {
+        return mutex ? std::unique_lock{*mutex} : std::unique_lock<ResourceMutex>{};
+    }
+
+    template <typename T>
+    struct LockedDelete {
+        ResourceMutex* mutex = nullptr;
+
+        void operator() (T* ptr) const {
+            auto lock = LockResource(mutex);
+            delete ptr;
+        }
+    };
+
+    // Backend resource destroyed under the lock of the renderer that made it
+    template <typename T>
+    using LockedPtr = std::unique_ptr<T, LockedDelete<T>>;
+
+    template <typename T>
+    LockedPtr<T> MakeLocked (std::unique_ptr<T> ptr, ResourceMutex& mutex) {
+        return LockedPtr<T>{ptr.release(), LockedDelete<T>{&mutex}};
+    }
+
+    template <typename T>
+    std::unique_lock<ResourceMutex> LockResource (const LockedPtr<T>& ptr) {
+        return LockResource(ptr.get_deleter().mutex);
+    }
+} // namespace detail
+} // namespace phenyl::graphics
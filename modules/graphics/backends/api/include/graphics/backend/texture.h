@@ -2,6 +2,7 @@
 
 #include "core/assets/asset.h"
 #include "graphics/image.h"
+#include "resource_lock.h"
 
 #include <memory>
 
@@ -97,7 +98,7 @@ class ImageTexture : public Texture {
 public:
     ImageTexture () = default;
 
-    explicit ImageTexture (std::unique_ptr<IImageTexture> texture) : Texture{0}, m_texture{std::move(texture)} {}
+    explicit ImageTexture (detail::LockedPtr<IImageTexture> texture) : Texture{0}, m_texture{std::move(texture)} {}
 
     explicit operator bool () const noexcept {
         return (bool) m_texture;
@@ -112,6 +113,7 @@ public:
     }
 
     void upload (const Image& image) {
+        auto lock = detail::LockResource(m_texture);
         m_texture->upload(image);
     }
 
@@ -120,14 +122,14 @@ public:
     }
 
 private:
-    std::unique_ptr<IImageTexture> m_texture;
+    detail::LockedPtr<IImageTexture> m_texture;
 };
 
 class ImageArrayTexture : public Texture {
 public:
     ImageArrayTexture () = default;
 
-    explicit ImageArrayTexture (std::unique_ptr<IImageArrayTexture> texture) :
+    explicit ImageArrayTexture (detail::LockedPtr<IImageArrayTexture> texture) :
         Texture{texture->sampler().hash()},
         m_texture{std::move(texture)} {}
 
@@ -148,14 +150,17 @@ public:
     }
 
     void reserve (std::uint32_t capacity) {
+        auto lock = detail::LockResource(m_texture);
         m_texture->reserve(capacity);
     }
 
     std::uint32_t append () {
+        auto lock = detail::LockResource(m_texture);
         return m_texture->append();
     }
 
     void upload (std::uint32_t index, const Image& image) {
+        auto lock = detail::LockResource(m_texture);
         m_texture->upload(index, image);
     }
 
@@ -164,6 +169,6 @@ public:
     }
 
 private:
-    std::unique_ptr<IImageArrayTexture> m_texture;
+    detail::LockedPtr<IImageArrayTexture> m_texture;
 };
 } // namespace phenyl::graphics
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "logging/logging.h"
+#include "resource_lock.h"
 
 #include <cstddef>
 #include <memory>
@@ -22,7 +23,7 @@ public:
     UniformBuffer () = default;
 
     template <typename... Args>
-    explicit UniformBuffer(std::unique_ptr<IUniformBuffer> rendererBuffer, Args&&... args)
+    explicit UniformBuffer(detail::LockedPtr<IUniformBuffer> rendererBuffer, Args&&... args)
         requires (std::constructible_from<T, Args && ...>)
         : m_buffer{std::move(rendererBuffer)} {
         PHENYL_DASSERT(this->m_buffer);
@@ -67,6 +68,7 @@ public:
 
     void upload () {
         PHENYL_DASSERT(m_buffer);
+        auto lock = detail::LockResource(m_buffer);
         m_buffer->upload();
     }
 
@@ -86,7 +88,7 @@ public:
     }
 
 private:
-    std::unique_ptr<IUniformBuffer> m_buffer;
+    detail::LockedPtr<IUniformBuffer> m_buffer;
     T* m_data;
 };
 
@@ -95,7 +97,7 @@ class UniformArrayBuffer {
 public:
     UniformArrayBuffer () = default;
 
-    UniformArrayBuffer (std::unique_ptr<IUniformBuffer> rendererBuffer, std::size_t startCapacity = 8) :
+    UniformArrayBuffer (detail::LockedPtr<IUniformBuffer> rendererBuffer, std::size_t startCapacity = 8) :
         m_buffer{std::move(rendererBuffer)},
         m_capacity{startCapacity} {
         PHENYL_DASSERT(this->m_buffer);
@@ -150,6 +152,7 @@ public:
 
     void upload () {
         PHENYL_DASSERT(m_buffer);
+        auto lock = detail::LockResource(m_buffer);
         m_buffer->upload();
     }
 
@@ -168,7 +171,7 @@ public:
     }
 
 private:
-    std::unique_ptr<IUniformBuffer> m_buffer;
+    detail::LockedPtr<IUniformBuffer> m_buffer;
     std::byte* m_data;
     std::size_t m_stride = 0;
     std::size_t m_size = 0;
@@ -183,6 +186,7 @@ private:
             m_capacity *= 2;
         }
 
+        auto lock = detail::LockResource(m_buffer);
         m_data = this->m_buffer->allocate(m_stride * m_capacity).data();
     }
 
@@ -195,7 +199,7 @@ class RawUniformBuffer {
 public:
     RawUniformBuffer () = default;
 
-    RawUniformBuffer (std::unique_ptr<IUniformBuffer> rendererBuffer, std::size_t size) :
+    RawUniformBuffer (detail::LockedPtr<IUniformBuffer> rendererBuffer, std::size_t size) :
         m_buffer{std::move(rendererBuffer)} {
         m_data = this->m_buffer->allocate(size);
     }
@@ -223,6 +227,7 @@ public:
 
     void upload () {
         PHENYL_DASSERT(m_buffer);
+        auto lock = detail::LockResource(m_buffer);
         m_buffer->upload();
     }
 
@@ -237,7 +242,7 @@ public:
     }
 
 private:
-    std::unique_ptr<IUniformBuffer> m_buffer;
+    detail::LockedPtr<IUniformBuffer> m_buffer;
     std::span<std::byte> m_data;
 };
 } // namespace phenyl::graphics
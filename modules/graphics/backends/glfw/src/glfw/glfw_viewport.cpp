@@ -2,7 +2,6 @@
 
 #include "core/input/game_input.h"
 #include "logging/logging.h"
-#include "util/profiler.h"
 
 using namespace phenyl::glfw;
 
@@ -54,8 +53,6 @@ GLFWViewport::GLFWViewport (const graphics::GraphicsProperties& properties,
     postInitCallback(m_window);
     PHENYL_LOGI(detail::GLFW_LOGGER, "Initialised GLFW viewport");
     setupCallbacks();
-
-    util::setProfilerTimingFunction(glfwGetTime);
 }
 
 GLFWViewport::~GLFWViewport () {
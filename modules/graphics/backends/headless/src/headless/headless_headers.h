@@ -0,0 +1,7 @@
+#pragma once
+
+#include "logging/logging.h"
+
+namespace phenyl::headless::detail {
+extern phenyl::Logger HEADLESS_LOGGER;
+} // namespace phenyl::headless::detail
@@ -0,0 +1,77 @@
+#include "headless_renderer.h"
+
+using namespace phenyl::headless;
+
+phenyl::Logger phenyl::headless::detail::HEADLESS_LOGGER{"HEADLESS", phenyl::PHENYL_LOGGER};
+
+HeadlessRenderer::HeadlessRenderer (const graphics::GraphicsProperties& properties) :
+    m_viewport{properties},
+    m_startTime{std::chrono::steady_clock::now()} {
+    m_shaderManager.selfRegister();
+    PHENYL_LOGI(detail::HEADLESS_LOGGER, "Completed headless renderer setup");
+}
+
+std::string_view HeadlessRenderer::getName () const noexcept {
+    return "HeadlessRenderer";
+}
+
+double HeadlessRenderer::getCurrentTime () {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+void HeadlessRenderer::clearWindow () {}
+
+void HeadlessRenderer::render () {
+    layerRender();
+}
+
+void HeadlessRenderer::finishRender () {}
+
+std::unique_ptr<phenyl::graphics::IPipelineBuilder> HeadlessRenderer::makeRendererPipelineBuilder () {
+    return std::make_unique<HeadlessPipelineBuilder>();
+}
+
+void HeadlessRenderer::loadDefaultShaders () {
+    m_shaderManager.loadDefaultShaders();
+}
+
+phenyl::graphics::Viewport& HeadlessRenderer::getViewport () {
+    return m_viewport;
+}
+
+const phenyl::graphics::Viewport& HeadlessRenderer::getViewport () const {
+    return m_viewport;
+}
+
+std::unique_ptr<phenyl::graphics::IBuffer> HeadlessRenderer::makeRendererBuffer (std::size_t startCapacity,
+    std::size_t elementSize, graphics::BufferStorageHint storageHint, bool isIndex) {
+    return std::make_unique<HeadlessBuffer>();
+}
+
+std::unique_ptr<phenyl::graphics::IUniformBuffer> HeadlessRenderer::makeRendererUniformBuffer (bool readable) {
+    return std::make_unique<HeadlessUniformBuffer>();
+}
+
+std::unique_ptr<phenyl::graphics::IImageTexture> HeadlessRenderer::makeRendererImageTexture (
+    const graphics::TextureProperties& properties) {
+    return std::make_unique<HeadlessImageTexture>();
+}
+
+std::unique_ptr<phenyl::graphics::IImageArrayTexture> HeadlessRenderer::makeRendererArrayTexture (
+    const graphics::TextureProperties& properties, std::uint32_t width, std::uint32_t height) {
+    return std::make_unique<HeadlessImageArrayTexture>();
+}
+
+std::unique_ptr<phenyl::graphics::IFrameBuffer> HeadlessRenderer::makeRendererFrameBuffer (
+    const graphics::FrameBufferProperties& properties, std::uint32_t width, std::uint32_t height) {
+    return std::make_unique<HeadlessFrameBuffer>(width, height);
+}
+
+phenyl::graphics::ICommandList* HeadlessRenderer::makeCommandList () {
+    return &m_commandList;
+}
+
+std::unique_ptr<phenyl::graphics::Renderer> phenyl::graphics::MakeHeadlessRenderer (
+    const GraphicsProperties& properties) {
+    return std::make_unique<HeadlessRenderer>(properties);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "graphics/backend/renderer.h"
+#include "headless_resources.h"
+#include "headless_shader.h"
+#include "headless_viewport.h"
+
+#include <chrono>
+#include <memory>
+
+namespace phenyl::headless {
+// Renderer that draws nothing, for running the simulation without a window or GPU. Render layers still run every
+// frame so the data they batch up is consumed, but every buffer, texture and pipeline is a no-op
+class HeadlessRenderer : public graphics::Renderer {
+public:
+    explicit HeadlessRenderer (const graphics::GraphicsProperties& properties);
+
+    [[nodiscard]] std::string_view getName () const noexcept override;
+
+    double getCurrentTime () override;
+
+    void clearWindow () override;
+    void render () override;
+    void finishRender () override;
+
+    void loadDefaultShaders () override;
+
+    graphics::Viewport& getViewport () override;
+    const graphics::Viewport& getViewport () const override;
+
+protected:
+    std::unique_ptr<graphics::IPipelineBuilder> makeRendererPipelineBuilder () override;
+    std::unique_ptr<graphics::IBuffer> makeRendererBuffer (std::size_t startCapacity, std::size_t elementSize,
+        graphics::BufferStorageHint storageHint, bool isIndex) override;
+    std::unique_ptr<graphics::IUniformBuffer> makeRendererUniformBuffer (bool readable) override;
+    std::unique_ptr<graphics::IImageTexture> makeRendererImageTexture (
+        const graphics::TextureProperties& properties) override;
+    std::unique_ptr<graphics::IImageArrayTexture> makeRendererArrayTexture (
+        const graphics::TextureProperties& properties, std::uint32_t width, std::uint32_t height) override;
+    std::unique_ptr<graphics::IFrameBuffer> makeRendererFrameBuffer (const graphics::FrameBufferProperties& properties,
+        std::uint32_t width, std::uint32_t height) override;
+    graphics::ICommandList* makeCommandList () override;
+
+private:
+    HeadlessViewport m_viewport;
+    HeadlessCommandList m_commandList;
+    HeadlessShaderManager m_shaderManager;
+    std::chrono::steady_clock::time_point m_startTime;
+};
+} // namespace phenyl::headless
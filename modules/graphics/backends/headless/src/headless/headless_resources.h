@@ -0,0 +1,182 @@
+#pragma once
+
+#include "graphics/backend/buffer.h"
+#include "graphics/backend/command_list.h"
+#include "graphics/backend/framebuffer.h"
+#include "graphics/backend/pipeline.h"
+#include "graphics/backend/texture.h"
+#include "graphics/backend/uniform_buffer.h"
+
+#include <vector>
+
+namespace phenyl::headless {
+class HeadlessBuffer : public graphics::IBuffer {
+public:
+    void upload (std::span<const std::byte> data) override {}
+};
+
+class HeadlessUniformBuffer : public graphics::IUniformBuffer {
+public:
+    // Writes still need somewhere to go, so the memory is kept even though nothing reads it
+    std::span<std::byte> allocate (std::size_t size) override {
+        m_data.resize(size);
+        return m_data;
+    }
+
+    void upload () override {}
+
+    bool isReadable () const override {
+        return false;
+    }
+
+    std::size_t getMinAlignment () const noexcept override {
+        return 8;
+    }
+
+private:
+    std::vector<std::byte> m_data;
+};
+
+class HeadlessSampler : public graphics::ISampler {
+public:
+    [[nodiscard]] std::size_t hash () const noexcept override {
+        return 0;
+    }
+};
+
+class HeadlessImageTexture : public graphics::IImageTexture {
+public:
+    [[nodiscard]] std::uint32_t width () const noexcept override {
+        return 1;
+    }
+
+    [[nodiscard]] std::uint32_t height () const noexcept override {
+        return 1;
+    }
+
+    void upload (const graphics::Image& image) override {}
+
+    [[nodiscard]] graphics::ISampler& sampler () noexcept override {
+        return m_sampler;
+    }
+
+private:
+    HeadlessSampler m_sampler;
+};
+
+class HeadlessImageArrayTexture : public graphics::IImageArrayTexture {
+public:
+    [[nodiscard]] std::uint32_t width () const noexcept override {
+        return 1;
+    }
+
+    [[nodiscard]] std::uint32_t height () const noexcept override {
+        return 1;
+    }
+
+    [[nodiscard]] std::uint32_t size () const noexcept override {
+        return m_size;
+    }
+
+    void reserve (std::uint32_t capacity) override {}
+
+    std::uint32_t append () override {
+        return m_size++;
+    }
+
+    void upload (std::uint32_t index, const graphics::Image& image) override {}
+
+    [[nodiscard]] graphics::ISampler& sampler () noexcept override {
+        return m_sampler;
+    }
+
+private:
+    HeadlessSampler m_sampler;
+    std::uint32_t m_size = 0;
+};
+
+class HeadlessPipeline : public graphics::IPipeline {
+public:
+    void bindBuffer (meta::TypeIndex type, graphics::BufferBinding binding, const graphics::IBuffer& buffer,
+        std::size_t offset) override {}
+
+    void bindIndexBuffer (graphics::ShaderIndexType type, const graphics::IBuffer& buffer) override {}
+
+    void bindUniform (meta::TypeIndex type, graphics::UniformBinding binding, const graphics::IUniformBuffer& buffer,
+        std::size_t offset, std::size_t size) override {}
+
+    void bindSampler (graphics::SamplerBinding binding, graphics::ISampler& sampler) override {}
+
+    void unbindIndexBuffer () override {}
+
+    void render (graphics::ICommandList& list, graphics::IFrameBuffer* fb, std::size_t vertices,
+        std::size_t offset) override {}
+
+    void renderInstanced (graphics::ICommandList& list, graphics::IFrameBuffer* fb, std::size_t numInstances,
+        std::size_t vertices, std::size_t offset) override {}
+};
+
+class HeadlessPipelineBuilder : public graphics::IPipelineBuilder {
+public:
+    void withBlendMode (graphics::BlendMode mode) override {}
+
+    void withDepthTesting (bool doDepthWrite) override {}
+
+    void withCullMode (graphics::CullMode mode) override {}
+
+    void withGeometryType (graphics::GeometryType type) override {}
+
+    void withShader (const std::shared_ptr<graphics::Shader>& shader) override {}
+
+    graphics::BufferBinding withBuffer (meta::TypeIndex type, std::size_t size,
+        graphics::BufferInputRate inputRate) override {
+        return m_nextBuffer++;
+    }
+
+    void withAttrib (graphics::ShaderDataType type, unsigned location, graphics::BufferBinding binding,
+        std::size_t offset) override {}
+
+    graphics::UniformBinding withUniform (meta::TypeIndex type, unsigned location) override {
+        return m_nextUniform++;
+    }
+
+    graphics::SamplerBinding withSampler (unsigned location) override {
+        return m_nextSampler++;
+    }
+
+    std::unique_ptr<graphics::IPipeline> build () override {
+        return std::make_unique<HeadlessPipeline>();
+    }
+
+private:
+    graphics::BufferBinding m_nextBuffer = 0;
+    graphics::UniformBinding m_nextUniform = 0;
+    graphics::SamplerBinding m_nextSampler = 0;
+};
+
+class HeadlessFrameBuffer : public graphics::IFrameBuffer {
+public:
+    HeadlessFrameBuffer (std::uint32_t width, std::uint32_t height) :
+        m_dimensions{static_cast<int>(width), static_cast<int>(height)} {}
+
+    void clear (glm::vec4 clearColor) override {}
+
+    graphics::ISampler* getSampler () noexcept override {
+        return &m_sampler;
+    }
+
+    graphics::ISampler* getDepthSampler () noexcept override {
+        return &m_sampler;
+    }
+
+    glm::ivec2 getDimensions () const noexcept override {
+        return m_dimensions;
+    }
+
+private:
+    HeadlessSampler m_sampler;
+    glm::ivec2 m_dimensions;
+};
+
+class HeadlessCommandList : public graphics::ICommandList {};
+} // namespace phenyl::headless
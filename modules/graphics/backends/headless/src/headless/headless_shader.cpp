@@ -0,0 +1,39 @@
+#include "headless_shader.h"
+
+#include "core/assets/assets.h"
+
+using namespace phenyl::headless;
+
+// Every default shader the graphics plugins and render layers look up
+static constexpr std::string_view DEFAULT_SHADERS[] = {
+    "phenyl/shaders/box",
+    "phenyl/shaders/debug",
+    "phenyl/shaders/sprite",
+    "phenyl/shaders/canvas",
+    "phenyl/shaders/particle",
+    "phenyl/shaders/blinn_phong",
+    "phenyl/shaders/shadow_map",
+    "phenyl/shaders/mesh_prepass",
+    "phenyl/shaders/postprocess/noop",
+    "phenyl/shaders/test",
+};
+
+HeadlessShaderManager::~HeadlessShaderManager () {
+    core::Assets::RemoveManager(this);
+}
+
+std::shared_ptr<phenyl::graphics::Shader> HeadlessShaderManager::load (core::AssetLoadContext& ctx) {
+    return std::make_shared<graphics::Shader>(std::make_unique<HeadlessShader>());
+}
+
+void HeadlessShaderManager::selfRegister () {
+    core::Assets::AddManager(this);
+}
+
+void HeadlessShaderManager::loadDefaultShaders () {
+    for (auto path : DEFAULT_SHADERS) {
+        PHENYL_LOGD(detail::HEADLESS_LOGGER, "Loaded default shader \"{}\"", path);
+        m_defaultShaders.emplace_back(std::make_shared<graphics::Shader>(std::make_unique<HeadlessShader>()));
+        core::Assets::LoadVirtual(path, m_defaultShaders.back());
+    }
+}
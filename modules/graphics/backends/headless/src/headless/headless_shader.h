@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/assets/asset_manager.h"
+#include "graphics/backend/shader.h"
+#include "headless_headers.h"
+
+#include <memory>
+#include <vector>
+
+namespace phenyl::headless {
+// Shader with no program behind it, which reports every attribute, uniform and sampler as present
+class HeadlessShader : public graphics::IShader {
+public:
+    [[nodiscard]] std::size_t hash () const noexcept override {
+        return 0;
+    }
+
+    [[nodiscard]] std::optional<unsigned int> getAttribLocation (std::string_view attrib) const noexcept override {
+        return 0;
+    }
+
+    [[nodiscard]] std::optional<unsigned int> getUniformLocation (const std::string& uniform) const noexcept override {
+        return 0;
+    }
+
+    [[nodiscard]] std::optional<unsigned int> getSamplerLocation (const std::string& sampler) const noexcept override {
+        return 0;
+    }
+
+    std::optional<std::size_t> getUniformOffset (const std::string& uniformBlock,
+        const std::string& uniform) const noexcept override {
+        return 0;
+    }
+
+    std::optional<std::size_t> getUniformBlockSize (const std::string& uniformBlock) const noexcept override {
+        return 0;
+    }
+};
+
+class HeadlessShaderManager : public core::AssetManager<graphics::Shader> {
+public:
+    ~HeadlessShaderManager () override;
+
+    std::shared_ptr<graphics::Shader> load (core::AssetLoadContext& ctx) override;
+    void selfRegister ();
+
+    void loadDefaultShaders ();
+
+private:
+    std::vector<std::shared_ptr<graphics::Shader>> m_defaultShaders;
+};
+} // namespace phenyl::headless
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "graphics/graphics_properties.h"
+#include "graphics/viewport.h"
+
+namespace phenyl::headless {
+// Viewport without a window. It never closes by itself and has no input devices, but keeps the configured window
+// size so cameras get the same aspect ratio as in a windowed run
+class HeadlessViewport : public graphics::Viewport {
+public:
+    explicit HeadlessViewport (const graphics::GraphicsProperties& properties) :
+        m_resolution{properties.getWindowWidth(), properties.getWindowHeight()} {}
+
+    [[nodiscard]] std::string_view getName () const noexcept override {
+        return "phenyl::HeadlessViewport";
+    }
+
+    [[nodiscard]] bool shouldClose () const override {
+        return false;
+    }
+
+    void poll () override {}
+
+    [[nodiscard]] glm::ivec2 getResolution () const override {
+        return m_resolution;
+    }
+
+    [[nodiscard]] glm::vec2 getContentScale () const override {
+        return {1, 1};
+    }
+
+    void addInputDevices (core::GameInput& manager) override {}
+
+    void addUpdateHandler (graphics::IViewportUpdateHandler* handler) override {}
+
+private:
+    glm::ivec2 m_resolution;
+};
+} // namespace phenyl::headless
@@ -157,8 +157,8 @@ std::unique_ptr<IBuffer> GLRenderer::makeRendererBuffer (std::size_t startCapaci
     return std::make_unique<GlBuffer>(startCapacity, elementSize, usage);
 }
 
-PipelineBuilder GLRenderer::buildPipeline () {
-    return PipelineBuilder(std::make_unique<GlPipelineBuilder>(&m_windowFrameBuffer));
+std::unique_ptr<IPipelineBuilder> GLRenderer::makeRendererPipelineBuilder () {
+    return std::make_unique<GlPipelineBuilder>(&m_windowFrameBuffer);
 }
 
 std::unique_ptr<IUniformBuffer> GLRenderer::makeRendererUniformBuffer (bool readable) {
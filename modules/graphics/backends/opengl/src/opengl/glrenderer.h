@@ -27,7 +27,6 @@ public:
     void render () override;
     void finishRender () override;
 
-    graphics::PipelineBuilder buildPipeline () override;
     void loadDefaultShaders () override;
 
     graphics::Viewport& getViewport () override;
@@ -36,6 +35,7 @@ public:
     void onViewportResize (glm::ivec2 oldResolution, glm::ivec2 newResolution) override;
 
 protected:
+    std::unique_ptr<graphics::IPipelineBuilder> makeRendererPipelineBuilder () override;
     std::unique_ptr<graphics::IBuffer> makeRendererBuffer (std::size_t startCapacity, std::size_t elementSize,
         graphics::BufferStorageHint storageHint, bool isIndex) override;
     std::unique_ptr<graphics::IUniformBuffer> makeRendererUniformBuffer (bool readable) override;
@@ -180,9 +180,8 @@ ICommandList* VulkanRenderer::makeCommandList () {
     return m_commandList ? &*m_commandList : nullptr;
 }
 
-PipelineBuilder VulkanRenderer::buildPipeline () {
-    return PipelineBuilder{
-      std::make_unique<VulkanPipelineBuilder>(*m_resources, *m_frameManager, m_windowFrameBuffer.get())};
+std::unique_ptr<IPipelineBuilder> VulkanRenderer::makeRendererPipelineBuilder () {
+    return std::make_unique<VulkanPipelineBuilder>(*m_resources, *m_frameManager, m_windowFrameBuffer.get());
 }
 
 void VulkanRenderer::loadDefaultShaders () {
@@ -28,13 +28,13 @@ public:
     void clearWindow () override;
     void render () override;
     void finishRender () override;
-    graphics::PipelineBuilder buildPipeline () override;
     void loadDefaultShaders () override;
     graphics::Viewport& getViewport () override;
     const graphics::Viewport& getViewport () const override;
     std::string_view getName () const noexcept override;
 
 protected:
+    std::unique_ptr<graphics::IPipelineBuilder> makeRendererPipelineBuilder () override;
     std::unique_ptr<graphics::IBuffer> makeRendererBuffer (std::size_t startCapacity, std::size_t elementSize,
         graphics::BufferStorageHint storageHint, bool isIndex) override;
     std::unique_ptr<graphics::IUniformBuffer> makeRendererUniformBuffer (bool readable) override;
@@ -14,6 +14,9 @@
 
 using namespace phenyl;
 
+static const util::ProfileZone GraphicsZone{"graphics"};
+static const util::ProfileZone PhysicsZone{"physics"};
+
 std::string_view graphics::ProfileUiPlugin::getName () const noexcept {
     return "ProfileUiPlugin";
 }
@@ -31,8 +34,8 @@ void graphics::ProfileUiPlugin::update (core::PhenylRuntime& runtime) {
 
     m_deltaTimeQueue.pushPop(static_cast<float>(clock.deltaTime()));
     m_frameQueue.pushPop(util::getProfileFrameTime());
-    m_graphicsQueue.pushPop(util::getProfileTime("graphics"));
-    m_physicsQueue.pushPop(util::getProfileTime("physics"));
+    m_graphicsQueue.pushPop(util::getProfileTime(GraphicsZone));
+    m_physicsQueue.pushPop(util::getProfileTime(PhysicsZone));
 }
 
 void graphics::ProfileUiPlugin::render (core::PhenylRuntime& runtime) {
@@ -48,6 +51,8 @@ void graphics::ProfileUiPlugin::render (core::PhenylRuntime& runtime) {
         "graphics: " + std::to_string(m_graphicsQueue.getSmoothed() * 1000) + "ms");
     canvas.renderText(glm::vec2{5, 45}, canvas.defaultFont(), 11,
         "frame time: " + std::to_string(m_frameQueue.getSmoothed() * 1000) + "ms");
+    canvas.renderText(glm::vec2{5, 60}, canvas.defaultFont(), 11,
+        "signals: " + std::to_string(runtime.resource<core::RuntimeStats>().signalsDispatched));
 
     canvas.renderText(glm::vec2{700, 15}, canvas.defaultFont(), 11,
         std::to_string(1.0f / m_deltaTimeQueue.getSmoothed()) + " fps", {0.0f, 1.0f, 0.0f});
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace phenyl::util {
+// Bump allocator that hands out memory from large blocks. Nothing is freed individually: reset() makes all of it
+// available again while keeping the blocks, so an arena reused every frame stops allocating once warmed up
+class Arena {
+public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+    explicit Arena (std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    Arena (const Arena&) = delete;
+    Arena (Arena&&) noexcept = default;
+
+    Arena& operator= (const Arena&) = delete;
+    Arena& operator= (Arena&&) noexcept = default;
+
+    void* allocate (std::size_t size, std::size_t align);
+
+    // Objects are never destroyed by the arena, callers must destroy non-trivial objects before reset()
+    template <typename T, typename... Args>
+    T* make (Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    void reset () noexcept;
+
+    // Bytes held by the arena, whether in use or not
+    [[nodiscard]] std::size_t capacity () const noexcept;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    std::size_t m_blockSize;
+    // Block currently being allocated from and the offset into it
+    std::size_t m_block = 0;
+    std::size_t m_offset = 0;
+
+    std::byte* tryAllocate (std::size_t size, std::size_t align) noexcept;
+};
+} // namespace phenyl::util
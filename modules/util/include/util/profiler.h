@@ -1,21 +1,94 @@
 #pragma once
 
-#include <functional>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace phenyl::util {
-void setProfilerTimingFunction (std::function<double(void)> timeFunc);
+using ProfileZoneId = std::uint32_t;
+static constexpr ProfileZoneId NoProfileZone = std::numeric_limits<ProfileZoneId>::max();
+
+// A named profile zone. Names are interned, so every zone with the same name shares an id
+class ProfileZone {
+public:
+    explicit ProfileZone (std::string_view name);
+
+    [[nodiscard]] ProfileZoneId id () const noexcept {
+        return m_id;
+    }
+
+    [[nodiscard]] std::string_view name () const noexcept {
+        return m_name;
+    }
+
+private:
+    ProfileZoneId m_id;
+    std::string_view m_name;
+};
+
+// Enters a zone on the calling thread, nested inside the zone the thread is currently in
+void beginProfileZone (const ProfileZone& zone) noexcept;
+// Leaves the innermost zone of the calling thread
+void endProfileZone () noexcept;
+
+// Times the enclosing scope as a zone
+class ProfileScope {
+public:
+    explicit ProfileScope (const ProfileZone& zone) noexcept {
+        beginProfileZone(zone);
+    }
+
+    ~ProfileScope () {
+        endProfileZone();
+    }
+
+    ProfileScope (const ProfileScope&) = delete;
+    ProfileScope (ProfileScope&&) = delete;
+
+    ProfileScope& operator= (const ProfileScope&) = delete;
+    ProfileScope& operator= (ProfileScope&&) = delete;
+};
+
+struct ProfileZoneStats {
+    std::string_view name;
+    // Zone the last call was nested in
+    ProfileZoneId parent = NoProfileZone;
+    std::uint32_t calls = 0;
+    // Seconds spent in the zone, summed over calls and threads
+    double time = 0;
+    // Seconds spent in the zone outside of any zones nested in it
+    double selfTime = 0;
+};
 
 void startProfileFrame ();
 
+// Aggregates the zones completed on all threads since the last frame into the frame stats. Must be called from the
+// same thread as startProfileFrame()
 void endProfileFrame ();
 
+// Stats of the last frame, indexed by zone id
+const std::vector<ProfileZoneStats>& getProfileFrameStats ();
+
+double getProfileTime (const ProfileZone& zone);
+
+double getProfileFrameTime ();
+
+// String keyed API, interns the name on every call
 void startProfile (const std::string& category);
 
 void endProfile ();
 
 double getProfileTime (const std::string& category);
+} // namespace phenyl::util
 
-double getProfileFrameTime ();
+#define PHENYL_PROFILE_CONCAT_IMPL(a, b) a##b
+#define PHENYL_PROFILE_CONCAT(a, b) PHENYL_PROFILE_CONCAT_IMPL(a, b)
 
-} // namespace phenyl::util
+// Times the enclosing scope. The name is interned once per call site, so entering the zone only costs a clock read
+#define PHENYL_PROFILE_SCOPE(name)                                                                               \
+    static const ::phenyl::util::ProfileZone PHENYL_PROFILE_CONCAT(phenylProfileZone, __LINE__){name};         \
+    ::phenyl::util::ProfileScope PHENYL_PROFILE_CONCAT(phenylProfileScope, __LINE__) {                         \
+        PHENYL_PROFILE_CONCAT(phenylProfileZone, __LINE__)                                                       \
+    }
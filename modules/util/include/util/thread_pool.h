@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace phenyl::util {
+class ThreadPool {
+public:
+    // Number of worker threads used by default, leaving a core for the calling thread
+    static std::size_t DefaultThreadCount ();
+
+    explicit ThreadPool (std::size_t numThreads = DefaultThreadCount());
+    ~ThreadPool ();
+
+    ThreadPool (const ThreadPool&) = delete;
+    ThreadPool (ThreadPool&&) = delete;
+
+    ThreadPool& operator= (const ThreadPool&) = delete;
+    ThreadPool& operator= (ThreadPool&&) = delete;
+
+    // Number of threads that may execute tasks concurrently, including the calling thread
+    [[nodiscard]] std::size_t concurrency () const noexcept {
+        return m_workers.size() + 1;
+    }
+
+    // Runs task(i) for every i in [0, numTasks) and blocks until all have completed. The calling thread takes part in
+    // the work, and while waiting for other threads steals tasks from any other parallelFor() in flight, so calls may
+    // be nested inside tasks.
+    void parallelFor (std::size_t numTasks, const std::function<void(std::size_t)>& task);
+
+    // Whether the current thread is executing a task from a parallelFor() call
+    static bool InTask () noexcept;
+    // Index of the task the current thread is executing, or 0 outside of tasks
+    static std::size_t CurrentTask () noexcept;
+    // 1 + the index of the current thread among the pool's workers, or 0 for any thread not owned by a pool
+    static std::size_t WorkerIndex () noexcept;
+
+private:
+    struct Job {
+        const std::function<void(std::size_t)>* task;
+        std::size_t numTasks;
+
+        std::atomic<std::size_t> nextTask = 0;
+        std::atomic<std::size_t> completedTasks = 0;
+        // Threads that may still claim tasks from this job
+        std::atomic<std::size_t> users = 0;
+
+        [[nodiscard]] bool hasWork () const noexcept {
+            return nextTask.load(std::memory_order_relaxed) < numTasks;
+        }
+
+        // Claims and runs tasks until none are left, returning whether any were run
+        bool run (std::size_t maxTasks = SIZE_MAX);
+    };
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::vector<Job*> m_jobs;
+    bool m_stopping = false;
+
+    void workerLoop (std::size_t index);
+    // Finds a job with unclaimed tasks and registers the caller as a user. Must be called with m_mutex held
+    Job* acquireJob ();
+    // Runs a single task of some other job, returning false if there was nothing to steal
+    bool steal ();
+};
+} // namespace phenyl::util
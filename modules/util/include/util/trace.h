@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+namespace phenyl::util {
+struct TraceEvent {
+    // Names are not copied, they must stay alive until the trace is written
+    std::string_view category;
+    std::string_view name;
+    std::int64_t start;
+    std::int64_t duration;
+};
+
+namespace detail {
+extern std::atomic<bool> TRACE_ENABLED;
+} // namespace detail
+
+class Trace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Number of events kept per thread, older events are overwritten
+    static constexpr std::size_t BufferCapacity = 1 << 16;
+
+    static void SetEnabled (bool enabled) noexcept;
+
+    static bool Enabled () noexcept {
+        return detail::TRACE_ENABLED.load(std::memory_order_relaxed);
+    }
+
+    // Records a complete event into the ring buffer of the calling thread
+    static void Record (std::string_view category, std::string_view name, Clock::time_point start,
+        Clock::time_point end) noexcept;
+
+    // Discards all recorded events. Must not race with Record()
+    static void Clear ();
+
+    // Number of events currently held across all threads
+    static std::size_t EventCount ();
+
+    // Writes all recorded events in the Chrome trace event format, viewable in chrome://tracing or Perfetto
+    static void WriteChromeTrace (std::ostream& out);
+};
+
+// Records the lifetime of the zone as a trace event if tracing was enabled when it was created
+class TraceZone {
+public:
+    TraceZone (std::string_view category, std::string_view name) noexcept : m_enabled{Trace::Enabled()} {
+        if (m_enabled) {
+            m_category = category;
+            m_name = name;
+            m_start = Trace::Clock::now();
+        }
+    }
+
+    ~TraceZone () {
+        if (m_enabled) {
+            Trace::Record(m_category, m_name, m_start, Trace::Clock::now());
+        }
+    }
+
+    TraceZone (const TraceZone&) = delete;
+    TraceZone (TraceZone&&) = delete;
+
+    TraceZone& operator= (const TraceZone&) = delete;
+    TraceZone& operator= (TraceZone&&) = delete;
+
+private:
+    bool m_enabled;
+    std::string_view m_category;
+    std::string_view m_name;
+    Trace::Clock::time_point m_start;
+};
+} // namespace phenyl::util
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <concepts>
 #include <format>
 #include <functional>
@@ -29,8 +30,9 @@ public:
 private:
     struct CurrIndex {
         static std::size_t GetNext () {
-            static std::size_t val = 1;
-            return val++;
+            // Types may be first seen concurrently from parallel systems
+            static std::atomic<std::size_t> val = 1;
+            return val.fetch_add(1, std::memory_order_relaxed);
         }
     };
 
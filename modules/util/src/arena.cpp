@@ -0,0 +1,61 @@
+#include "util/arena.h"
+
+#include "logging/logging.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace phenyl::util;
+
+Arena::Arena (std::size_t blockSize) : m_blockSize{blockSize} {
+    PHENYL_DASSERT(blockSize);
+}
+
+void* Arena::allocate (std::size_t size, std::size_t align) {
+    PHENYL_DASSERT(align && (align & (align - 1)) == 0);
+
+    // Blocks kept by reset() are reused before new ones are made
+    while (m_block < m_blocks.size()) {
+        if (auto* ptr = tryAllocate(size, align)) {
+            return ptr;
+        }
+
+        m_block++;
+        m_offset = 0;
+    }
+
+    // Oversized allocations get a block to themselves
+    auto blockSize = std::max(m_blockSize, size + align);
+    m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(blockSize), blockSize);
+    m_block = m_blocks.size() - 1;
+    m_offset = 0;
+
+    auto* ptr = tryAllocate(size, align);
+    PHENYL_DASSERT(ptr);
+    return ptr;
+}
+
+void Arena::reset () noexcept {
+    m_block = 0;
+    m_offset = 0;
+}
+
+std::size_t Arena::capacity () const noexcept {
+    std::size_t total = 0;
+    for (const auto& block : m_blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+std::byte* Arena::tryAllocate (std::size_t size, std::size_t align) noexcept {
+    auto& block = m_blocks[m_block];
+    void* ptr = block.data.get() + m_offset;
+    auto space = block.size - m_offset;
+    if (!std::align(align, size, ptr, space)) {
+        return nullptr;
+    }
+
+    m_offset = block.size - space + size;
+    return static_cast<std::byte*>(ptr);
+}
@@ -2,92 +2,197 @@
 
 #include "logging/logging.h"
 #include "util/detail/loggers.h"
+#include "util/trace.h"
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
-#include <vector>
 
 using namespace phenyl;
 
 static Logger LOGGER{"PROFILER", util::detail::UTIL_LOGGER};
 
-struct Profiler {
-    double lastFrameTime = 0;
-    double frameStartTime = 0;
+namespace {
+using Clock = std::chrono::steady_clock;
 
-    std::unordered_map<std::string, double> lastProfileTime;
+// Completed zones buffered per thread until the next frame is aggregated
+constexpr std::size_t EventCapacity = 1 << 14;
 
-    std::unordered_map<std::string, double> currentProfileTime;
+struct ProfileEvent {
+    util::ProfileZoneId zone;
+    util::ProfileZoneId parent;
+    std::int64_t duration;
+};
 
-    std::unordered_map<std::string, double> profileStartTime;
+// Single producer (the owning thread), single consumer (endProfileFrame())
+struct ThreadEvents {
+    std::unique_ptr<ProfileEvent[]> events = std::make_unique<ProfileEvent[]>(EventCapacity);
+    std::atomic<std::uint64_t> head = 0;
+    std::atomic<std::uint64_t> tail = 0;
+    std::atomic<std::uint64_t> dropped = 0;
+
+    void push (const ProfileEvent& event) noexcept {
+        auto index = head.load(std::memory_order_relaxed);
+        if (index - tail.load(std::memory_order_acquire) >= EventCapacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
 
-    std::vector<std::string> activeCategories;
+        events[index & (EventCapacity - 1)] = event;
+        head.store(index + 1, std::memory_order_release);
+    }
+};
 
-    std::unordered_set<std::string> activeSet;
+struct OpenZone {
+    util::ProfileZoneId zone;
+    std::string_view name;
+    Clock::time_point start;
+};
 
-    std::function<double(void)> timeFunc;
+struct ThreadState {
+    ThreadEvents* events = nullptr;
+    std::vector<OpenZone> openZones;
 };
 
-static Profiler profiler;
+struct Profiler {
+    std::mutex mutex;
+    // Deque so the interned names never move
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, util::ProfileZoneId> zoneIds;
+    // Buffers outlive their threads so events of finished threads are still aggregated
+    std::vector<std::unique_ptr<ThreadEvents>> threads;
+
+    // Only accessed from the thread running the frame
+    Clock::time_point frameStart;
+    double lastFrameTime = 0;
+    std::vector<util::ProfileZoneStats> lastFrame;
+};
 
-void util::setProfilerTimingFunction (std::function<double()> timeFunc) {
-    profiler.timeFunc = std::move(timeFunc);
+Profiler& GetProfiler () {
+    static Profiler profiler;
+    return profiler;
 }
 
-void util::startProfileFrame () {
-    profiler.frameStartTime = profiler.timeFunc();
+ThreadState& GetThreadState () {
+    thread_local ThreadState state;
+    if (!state.events) {
+        auto& profiler = GetProfiler();
+        std::scoped_lock lock{profiler.mutex};
+        state.events = profiler.threads.emplace_back(std::make_unique<ThreadEvents>()).get();
+    }
+    return state;
 }
+} // namespace
 
-void util::endProfileFrame () {
-    double time = profiler.timeFunc();
-    profiler.lastFrameTime = time - profiler.frameStartTime;
+static_assert((EventCapacity & (EventCapacity - 1)) == 0, "Profile event capacity must be a power of 2");
 
-    for (auto& i : profiler.activeCategories) {
-        profiler.currentProfileTime[i] += time - profiler.profileStartTime[i];
+util::ProfileZone::ProfileZone (std::string_view name) {
+    auto& profiler = GetProfiler();
+    std::scoped_lock lock{profiler.mutex};
+
+    if (auto it = profiler.zoneIds.find(name); it != profiler.zoneIds.end()) {
+        m_id = it->second;
+        m_name = it->first;
+        return;
     }
 
-    profiler.lastProfileTime = profiler.currentProfileTime;
+    m_id = static_cast<ProfileZoneId>(profiler.names.size());
+    m_name = profiler.names.emplace_back(name);
+    profiler.zoneIds.emplace(m_name, m_id);
+}
+
+void util::beginProfileZone (const ProfileZone& zone) noexcept {
+    GetThreadState().openZones.push_back(OpenZone{zone.id(), zone.name(), Clock::now()});
+}
 
-    for (auto& i : profiler.currentProfileTime) {
-        i.second = 0;
+void util::endProfileZone () noexcept {
+    auto end = Clock::now();
+    auto& state = GetThreadState();
+    if (state.openZones.empty()) {
+        PHENYL_LOGW(LOGGER, "Profiler has no active zones to end!");
+        return;
     }
 
-    profiler.activeCategories.clear();
-    profiler.activeSet.clear();
-}
+    auto zone = state.openZones.back();
+    state.openZones.pop_back();
 
-void util::startProfile (const std::string& category) {
-    if (!profiler.activeSet.contains(category)) {
-        profiler.activeCategories.emplace_back(category);
-        profiler.activeSet.emplace(category);
+    state.events->push(ProfileEvent{
+      .zone = zone.zone,
+      .parent = state.openZones.empty() ? NoProfileZone : state.openZones.back().zone,
+      .duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - zone.start).count(),
+    });
 
-        profiler.profileStartTime[category] = profiler.timeFunc();
-        if (!profiler.currentProfileTime.contains(category)) {
-            profiler.currentProfileTime[category] = 0;
-        }
+    if (Trace::Enabled()) {
+        Trace::Record("profile", zone.name, zone.start, end);
     }
 }
 
-void util::endProfile () {
-    auto time = profiler.timeFunc();
-    if (profiler.activeSet.empty()) {
-        PHENYL_LOGW(LOGGER, "Profiler has not active categories to end!");
-    } else {
-        auto category = profiler.activeCategories.back();
+void util::startProfileFrame () {
+    GetProfiler().frameStart = Clock::now();
+}
 
-        profiler.currentProfileTime[category] += time - profiler.profileStartTime[category];
+void util::endProfileFrame () {
+    auto& profiler = GetProfiler();
+    profiler.lastFrameTime = std::chrono::duration<double>(Clock::now() - profiler.frameStart).count();
+
+    std::scoped_lock lock{profiler.mutex};
+    auto& frame = profiler.lastFrame;
+    frame.resize(profiler.names.size());
+    for (std::size_t i = 0; i < frame.size(); i++) {
+        frame[i] = ProfileZoneStats{.name = profiler.names[i]};
+    }
 
-        profiler.activeSet.erase(category);
+    std::uint64_t dropped = 0;
+    for (auto& thread : profiler.threads) {
+        auto head = thread->head.load(std::memory_order_acquire);
+        for (auto i = thread->tail.load(std::memory_order_relaxed); i < head; i++) {
+            const auto& event = thread->events[i & (EventCapacity - 1)];
+            auto duration = static_cast<double>(event.duration) * 1e-9;
+
+            auto& stats = frame[event.zone];
+            stats.parent = event.parent;
+            stats.calls++;
+            stats.time += duration;
+            stats.selfTime += duration;
+            if (event.parent != NoProfileZone) {
+                frame[event.parent].selfTime -= duration;
+            }
+        }
+        thread->tail.store(head, std::memory_order_release);
+        dropped += thread->dropped.exchange(0, std::memory_order_relaxed);
+    }
 
-        profiler.activeCategories.pop_back();
+    if (dropped) {
+        PHENYL_LOGW(LOGGER, "Dropped {} profile events, more than {} zones ended on one thread in a frame", dropped,
+            EventCapacity);
     }
 }
 
-double util::getProfileTime (const std::string& category) {
-    return profiler.lastProfileTime[category];
+const std::vector<util::ProfileZoneStats>& util::getProfileFrameStats () {
+    return GetProfiler().lastFrame;
+}
+
+double util::getProfileTime (const ProfileZone& zone) {
+    const auto& frame = GetProfiler().lastFrame;
+    return zone.id() < frame.size() ? frame[zone.id()].time : 0.0;
 }
 
 double util::getProfileFrameTime () {
-    return profiler.lastFrameTime;
+    return GetProfiler().lastFrameTime;
+}
+
+void util::startProfile (const std::string& category) {
+    beginProfileZone(ProfileZone{category});
+}
+
+void util::endProfile () {
+    endProfileZone();
+}
+
+double util::getProfileTime (const std::string& category) {
+    return getProfileTime(ProfileZone{category});
 }
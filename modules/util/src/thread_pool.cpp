@@ -0,0 +1,163 @@
+#include "util/thread_pool.h"
+
+#include "logging/logging.h"
+#include "util/detail/loggers.h"
+
+#include <algorithm>
+
+using namespace phenyl::util;
+
+static phenyl::Logger LOGGER{"THREAD_POOL", detail::UTIL_LOGGER};
+
+static thread_local std::size_t TaskDepth = 0;
+static thread_local std::size_t TaskIndex = 0;
+static thread_local std::size_t WorkerId = 0;
+
+std::size_t ThreadPool::DefaultThreadCount () {
+    auto hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+ThreadPool::ThreadPool (std::size_t numThreads) {
+    m_workers.reserve(numThreads);
+    for (std::size_t i = 0; i < numThreads; i++) {
+        m_workers.emplace_back([this, i] () { workerLoop(i + 1); });
+    }
+
+    PHENYL_LOGI(LOGGER, "Started thread pool with {} worker threads", numThreads);
+}
+
+ThreadPool::~ThreadPool () {
+    {
+        std::lock_guard lock{m_mutex};
+        PHENYL_DASSERT(m_jobs.empty());
+        m_stopping = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (auto& i : m_workers) {
+        i.join();
+    }
+}
+
+void ThreadPool::parallelFor (std::size_t numTasks, const std::function<void(std::size_t)>& task) {
+    if (!numTasks) {
+        return;
+    }
+
+    if (numTasks == 1 || m_workers.empty()) {
+        // Not worth waking workers
+        auto prevIndex = TaskIndex;
+        TaskDepth++;
+        for (std::size_t i = 0; i < numTasks; i++) {
+            TaskIndex = i;
+            task(i);
+        }
+        TaskDepth--;
+        TaskIndex = prevIndex;
+        return;
+    }
+
+    Job job{.task = &task, .numTasks = numTasks};
+    {
+        std::lock_guard lock{m_mutex};
+        m_jobs.emplace_back(&job);
+    }
+    m_workAvailable.notify_all();
+
+    job.run();
+
+    // Help out with other work until every task of this job has finished
+    while (job.completedTasks.load(std::memory_order_acquire) < numTasks) {
+        if (!steal()) {
+            std::this_thread::yield();
+        }
+    }
+
+    {
+        std::lock_guard lock{m_mutex};
+        std::erase(m_jobs, &job);
+    }
+
+    // Workers that picked up the job before it was removed may not have noticed it is finished yet
+    while (job.users.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+bool ThreadPool::InTask () noexcept {
+    return TaskDepth;
+}
+
+std::size_t ThreadPool::CurrentTask () noexcept {
+    return TaskIndex;
+}
+
+std::size_t ThreadPool::WorkerIndex () noexcept {
+    return WorkerId;
+}
+
+bool ThreadPool::Job::run (std::size_t maxTasks) {
+    bool ranTask = false;
+    // Tasks may be run while waiting inside another task
+    auto prevIndex = TaskIndex;
+    TaskDepth++;
+    for (std::size_t count = 0; count < maxTasks; count++) {
+        auto i = nextTask.fetch_add(1, std::memory_order_relaxed);
+        if (i >= numTasks) {
+            break;
+        }
+
+        TaskIndex = i;
+        (*task)(i);
+        completedTasks.fetch_add(1, std::memory_order_release);
+        ranTask = true;
+    }
+    TaskDepth--;
+    TaskIndex = prevIndex;
+
+    return ranTask;
+}
+
+void ThreadPool::workerLoop (std::size_t index) {
+    WorkerId = index;
+    while (true) {
+        Job* job;
+        {
+            std::unique_lock lock{m_mutex};
+            m_workAvailable.wait(lock, [&] () { return m_stopping || (job = acquireJob()); });
+            if (m_stopping) {
+                return;
+            }
+        }
+
+        job->run();
+        job->users.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+ThreadPool::Job* ThreadPool::acquireJob () {
+    auto it = std::ranges::find_if(m_jobs, [] (const Job* job) { return job->hasWork(); });
+    if (it == m_jobs.end()) {
+        return nullptr;
+    }
+
+    (*it)->users.fetch_add(1, std::memory_order_relaxed);
+    return *it;
+}
+
+bool ThreadPool::steal () {
+    Job* job;
+    {
+        std::lock_guard lock{m_mutex};
+        job = acquireJob();
+    }
+
+    if (!job) {
+        return false;
+    }
+
+    auto ranTask = job->run(1);
+    job->users.fetch_sub(1, std::memory_order_release);
+    return ranTask;
+}
@@ -0,0 +1,157 @@
+#include "util/trace.h"
+
+#include "logging/logging.h"
+#include "util/detail/loggers.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+using namespace phenyl::util;
+
+static phenyl::Logger LOGGER{"TRACE", detail::UTIL_LOGGER};
+
+static_assert((Trace::BufferCapacity & (Trace::BufferCapacity - 1)) == 0, "Trace buffer capacity must be a power of 2");
+
+std::atomic<bool> detail::TRACE_ENABLED = false;
+
+namespace {
+// Only written to by its owning thread, so recording needs no locking
+struct ThreadBuffer {
+    std::uint32_t threadId;
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<std::uint64_t> count = 0;
+
+    explicit ThreadBuffer (std::uint32_t threadId) :
+        threadId{threadId},
+        events{std::make_unique<TraceEvent[]>(Trace::BufferCapacity)} {}
+};
+
+struct TraceBuffers {
+    std::mutex mutex;
+    // Buffers outlive their threads so events of finished threads can still be written out
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    Trace::Clock::time_point epoch = Trace::Clock::now();
+};
+
+TraceBuffers& GetBuffers () {
+    static TraceBuffers buffers;
+    return buffers;
+}
+
+ThreadBuffer& GetThreadBuffer () {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        auto& buffers = GetBuffers();
+        std::scoped_lock lock{buffers.mutex};
+        buffer = buffers.buffers
+                     .emplace_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(buffers.buffers.size())))
+                     .get();
+    }
+    return *buffer;
+}
+
+void WriteJsonString (std::ostream& out, std::string_view str) {
+    out << '"';
+    for (auto c : str) {
+        switch (c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out << ' ';
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+} // namespace
+
+void Trace::SetEnabled (bool enabled) noexcept {
+    // Make sure the epoch is set before any events are recorded
+    GetBuffers();
+    detail::TRACE_ENABLED.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::Record (std::string_view category, std::string_view name, Clock::time_point start,
+    Clock::time_point end) noexcept {
+    auto& buffer = GetThreadBuffer();
+    auto epoch = GetBuffers().epoch;
+
+    auto index = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[index & (BufferCapacity - 1)] = TraceEvent{
+      .category = category,
+      .name = name,
+      .start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count(),
+      .duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+    };
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Trace::Clear () {
+    auto& buffers = GetBuffers();
+    std::scoped_lock lock{buffers.mutex};
+    for (auto& buffer : buffers.buffers) {
+        buffer->count.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t Trace::EventCount () {
+    auto& buffers = GetBuffers();
+    std::scoped_lock lock{buffers.mutex};
+
+    std::size_t total = 0;
+    for (const auto& buffer : buffers.buffers) {
+        total += std::min<std::uint64_t>(buffer->count.load(std::memory_order_acquire), BufferCapacity);
+    }
+    return total;
+}
+
+void Trace::WriteChromeTrace (std::ostream& out) {
+    auto& buffers = GetBuffers();
+    std::scoped_lock lock{buffers.mutex};
+
+    std::size_t written = 0;
+    std::uint64_t overwritten = 0;
+    bool first = true;
+    out << "{\"traceEvents\":[";
+    for (const auto& buffer : buffers.buffers) {
+        auto count = buffer->count.load(std::memory_order_acquire);
+        auto begin = count > BufferCapacity ? count - BufferCapacity : 0;
+        overwritten += begin;
+
+        for (auto i = begin; i < count; i++) {
+            const auto& event = buffer->events[i & (BufferCapacity - 1)];
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            WriteJsonString(out, event.name);
+            out << ",\"cat\":";
+            WriteJsonString(out, event.category);
+            // Chrome trace timestamps are in microseconds
+            out << ",\"ph\":\"X\",\"ts\":" << static_cast<double>(event.start) / 1000.0
+                << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0 << ",\"pid\":1,\"tid\":" << buffer->threadId
+                << "}";
+            first = false;
+            written++;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    PHENYL_LOGI(LOGGER, "Wrote {} trace events from {} threads", written, buffers.buffers.size());
+    if (overwritten) {
+        PHENYL_LOGW(LOGGER, "{} older trace events were overwritten", overwritten);
+    }
+}
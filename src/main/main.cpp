@@ -1,12 +1,32 @@
+#include <cstdlib>
 #include <iostream>
 #include <phenyl/entrypoint.h>
 #include <phenyl/platform.h>
+#include <string_view>
 
 int main (int argc, char* argv[]) {
-    // TODO: parse cmdline args
     // phenyl_app_entrypoint(&engine, &properties);
     phenyl::ApplicationProperties properties;
     auto props = phenyl::ApplicationProperties{}.withLogFile("debug.log").withRootLogLevel(LEVEL_DEBUG);
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg{argv[i]};
+        if (arg == "--headless") {
+            props.withHeadless();
+        } else if (arg == "--pipelined") {
+            props.withPipelinedRendering();
+        } else if (arg == "--uncapped") {
+            props.withUncappedFixedStep();
+        } else if (arg == "--frames" && i + 1 < argc) {
+            props.withFrameLimit(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--steps" && i + 1 < argc) {
+            props.withFixedStepLimit(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--trace" && i + 1 < argc) {
+            props.withTraceFile(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument \"" << arg << "\"\n";
+            return EXIT_FAILURE;
+        }
+    }
     phenyl::PhenylEngine engine{props.logging()};
 
     phenyl::os::DynamicLibrary library{PHENYL_APP_LIB};
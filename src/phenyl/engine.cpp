@@ -2,16 +2,18 @@
 
 #include "core/runtime.h"
 #include "engine_clock.h"
+#include "frame_pacer.h"
+#include "render_thread.h"
 #include "graphics/backend/renderer.h"
 #include "graphics/phenyl_graphics.h"
 #include "logging/logging.h"
 #include "phenyl/app_plugin.h"
 #include "util/profiler.h"
+#include "util/trace.h"
 
 #include <chrono>
 #include <exception>
 #include <fstream>
-#include <thread>
 
 #define FIXED_FPS 60.0
 
@@ -22,9 +24,18 @@ static Logger LOGGER{"ENGINE", PHENYL_LOGGER};
 class engine::Engine {
 public:
     explicit Engine (const ApplicationProperties& properties) :
-        m_renderer{graphics::MakeVulkanRenderer(properties.m_graphics)},
+        m_renderer{properties.m_headless ? graphics::MakeHeadlessRenderer(properties.m_graphics) :
+                                           graphics::MakeVulkanRenderer(properties.m_graphics)},
         m_runtime(),
-        m_clock{std::chrono::duration_cast<EngineClock::Duration>(std::chrono::duration<double>(1.0 / FIXED_FPS))} {}
+        m_clock{std::chrono::duration_cast<EngineClock::Duration>(std::chrono::duration<double>(1.0 / FIXED_FPS))},
+        m_pacer{m_clock},
+        m_uncapped{properties.m_uncapped},
+        m_pipelined{properties.m_pipelinedRendering},
+        m_frameLimit{properties.m_frameLimit},
+        m_fixedStepLimit{properties.m_fixedStepLimit},
+        m_traceFile{properties.m_traceFile} {
+        m_clock.setMaxFixedSteps(properties.m_maxFixedSteps, properties.m_fixedStepOverflow);
+    }
 
     ~Engine () {
         PHENYL_LOGI(LOGGER, "Shutting down!");
@@ -48,33 +59,88 @@ public:
     void gameloop (ApplicationBase* app) {
         // double deltaPhysicsFrame = 0.0f;
         PHENYL_LOGD(LOGGER, "Starting loop!");
-        while (!m_renderer->getViewport().shouldClose()) {
+        if (m_pipelined) {
+            m_renderThread = std::make_unique<RenderThread>(*m_renderer);
+        }
+        if (!m_traceFile.empty()) {
+            util::Trace::SetEnabled(true);
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        while (!shouldStop()) {
             PHENYL_TRACE(LOGGER, "Frame start");
             util::startProfileFrame();
 
             m_runtime.runFrameBegin();
 
-            util::startProfile("physics");
-            while (m_clock.startFixedFrame()) {
-                PHENYL_TRACE(LOGGER, "Physics frame start");
-                fixedUpdate();
-                // m_fixedTimeSlop -= 1.0 / FIXED_FPS;
-                PHENYL_TRACE(LOGGER, "Physics frame end");
+            {
+                PHENYL_PROFILE_SCOPE("physics");
+                while (!fixedStepLimitReached() && m_clock.startFixedFrame()) {
+                    PHENYL_TRACE(LOGGER, "Physics frame start");
+                    fixedUpdate();
+                    m_fixedSteps++;
+                    // m_fixedTimeSlop -= 1.0 / FIXED_FPS;
+                    PHENYL_TRACE(LOGGER, "Physics frame end");
+                }
             }
-            util::endProfile();
 
-            util::startProfile("graphics");
-            m_clock.startVariableFrame();
-            update(m_clock.deltaTime());
-            render(m_clock.deltaTime());
-            util::endProfile();
+            {
+                PHENYL_PROFILE_SCOPE("graphics");
+                m_clock.startVariableFrame();
+                update(m_clock.deltaTime());
+                render(m_clock.deltaTime());
+            }
 
             util::endProfileFrame();
 
+            m_frames++;
             sync(app); // TODO
-            m_renderer->getViewport().poll();
+            if (!m_renderThread) {
+                m_renderer->getViewport().poll();
+            }
             PHENYL_TRACE(LOGGER, "Frame end");
         }
+
+        if (m_renderThread) {
+            m_renderThread->wait();
+            PHENYL_LOGI(LOGGER, "Render thread spent {}ms rendering, simulation spent {}ms waiting on it",
+                std::chrono::duration_cast<std::chrono::milliseconds>(m_renderThread->renderTime()).count(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(m_renderThread->waitTime()).count());
+            m_renderThread = nullptr;
+        }
+        if (!m_traceFile.empty()) {
+            // Zone names point into systems and stages, so the trace is written before the runtime is destroyed
+            writeTrace();
+        }
+
+        std::chrono::duration<double> runTime = std::chrono::steady_clock::now() - startTime;
+        PHENYL_LOGI(LOGGER, "Ran {} frames and {} fixed timesteps in {:.3f}s ({:.1f} fixed timesteps/s)", m_frames,
+            m_fixedSteps, runTime.count(), static_cast<double>(m_fixedSteps) / runTime.count());
+        PHENYL_LOGI(LOGGER, "Frame pacing error mean {}us max {}us, {} frames over time, {} fixed timesteps dropped",
+            std::chrono::duration_cast<std::chrono::microseconds>(m_pacer.meanError()).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(m_pacer.maxError()).count(), m_pacer.overrunFrames(),
+            m_clock.droppedFixedSteps());
+    }
+
+    void writeTrace () {
+        util::Trace::SetEnabled(false);
+        std::ofstream file{m_traceFile};
+        if (!file) {
+            PHENYL_LOGE(LOGGER, "Failed to open trace file \"{}\"", m_traceFile);
+            return;
+        }
+
+        util::Trace::WriteChromeTrace(file);
+        PHENYL_LOGI(LOGGER, "Wrote trace to \"{}\"", m_traceFile);
+    }
+
+    bool shouldStop () const {
+        return m_renderer->getViewport().shouldClose() || (m_frameLimit && m_frames >= m_frameLimit) ||
+            fixedStepLimitReached();
+    }
+
+    bool fixedStepLimitReached () const {
+        return m_fixedStepLimit && m_fixedSteps >= m_fixedStepLimit;
     }
 
     void update (double deltaTime) {
@@ -91,16 +157,35 @@ public:
 
     void render (double deltaTime) {
         PHENYL_TRACE(LOGGER, "Render start");
-        m_runtime.runRender();
-        m_renderer->render();
+        if (m_renderThread) {
+            // The Render stage fills the render layers, so the last frame has to be done reading them first
+            {
+                util::TraceZone zone{"graphics", "RenderThread::wait"};
+                m_renderThread->wait();
+            }
+            // Resize callbacks update render layers and the swap chain, so events are only handled while the render
+            // thread is idle
+            m_renderer->getViewport().poll();
+            m_runtime.runRender();
+            m_renderThread->submit();
+        } else {
+            m_runtime.runRender();
+            util::TraceZone zone{"graphics", "Renderer::render"};
+            m_renderer->render();
+        }
         PHENYL_TRACE(LOGGER, "Render end");
     }
 
     void sync (ApplicationBase* app) {
-        std::chrono::duration<double> targetFrameTime{1.0 / app->getTargetFps()};
-        while (!m_renderer->getViewport().shouldClose() && m_clock.frameTime() < targetFrameTime) {
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        if (m_uncapped) {
+            m_clock.step(app->getFixedTimeScale());
+            return;
         }
+
+        auto targetFrameTime = std::chrono::duration_cast<EngineClock::Duration>(
+            std::chrono::duration<double>{1.0 / app->getTargetFps()});
+        m_pacer.wait(targetFrameTime);
+        PHENYL_TRACE(LOGGER, "Frame pacing error: {}", m_pacer.lastError());
         m_clock.advance(app->getFixedTimeScale());
     }
 
@@ -108,6 +193,16 @@ private:
     std::unique_ptr<graphics::Renderer> m_renderer;
     core::PhenylRuntime m_runtime;
     EngineClock m_clock;
+    FramePacer m_pacer;
+    std::unique_ptr<RenderThread> m_renderThread;
+
+    bool m_uncapped;
+    bool m_pipelined;
+    std::uint64_t m_frameLimit;
+    std::uint64_t m_fixedStepLimit;
+    std::string m_traceFile;
+    std::uint64_t m_frames = 0;
+    std::uint64_t m_fixedSteps = 0;
 };
 
 PhenylEngine::PhenylEngine (const logging::LoggingProperties& properties) {
@@ -1,25 +1,49 @@
 #include "engine_clock.h"
 
+#include <thread>
+
 using namespace phenyl::engine;
 
-EngineClock::EngineClock (Duration fixedDeltaTime) :
+EngineClock::EngineClock (Duration fixedDeltaTime) : EngineClock{fixedDeltaTime, ClockType::now()} {}
+
+EngineClock::EngineClock (Duration fixedDeltaTime, TimePoint startTime) :
     m_fixedDeltaTime{fixedDeltaTime},
-    m_prevFrameTime{ClockType::now()} {}
+    m_prevFrameTime{startTime} {}
 
 void EngineClock::advance (double fixedTimeScale) {
-    auto now = ClockType::now();
-    m_deltaTime = now - m_prevFrameTime;
-    m_fixedTimeSlop += std::chrono::floor<Duration>((now - m_prevFrameTime) * fixedTimeScale);
-    m_prevFrameTime = now;
+    auto currTime = now();
+    m_deltaTime = currTime - m_prevFrameTime;
+    m_fixedTimeSlop += std::chrono::floor<Duration>((currTime - m_prevFrameTime) * fixedTimeScale);
+    m_prevFrameTime = currTime;
+    m_fixedSteps = 0;
+}
+
+void EngineClock::step (double fixedTimeScale) {
+    m_deltaTime = m_fixedDeltaTime;
+    m_fixedTimeSlop += std::chrono::floor<Duration>(m_fixedDeltaTime * fixedTimeScale);
+    m_prevFrameTime = now();
+    m_fixedSteps = 0;
+}
+
+void EngineClock::setMaxFixedSteps (std::uint32_t maxSteps, FixedStepOverflow overflow) {
+    m_maxFixedSteps = maxSteps;
+    m_overflow = overflow;
 }
 
 bool EngineClock::startFixedFrame () {
-    if (m_fixedTimeSlop >= m_fixedDeltaTime) {
-        m_fixedTimeSlop -= m_fixedDeltaTime;
-        isFixed = true;
-        return true;
+    if (m_fixedTimeSlop < m_fixedDeltaTime) {
+        return false;
+    }
+
+    if (m_maxFixedSteps && m_fixedSteps >= m_maxFixedSteps) {
+        limitBacklog();
+        return false;
     }
-    return false;
+
+    m_fixedTimeSlop -= m_fixedDeltaTime;
+    m_fixedSteps++;
+    isFixed = true;
+    return true;
 }
 
 void EngineClock::startVariableFrame () {
@@ -27,7 +51,7 @@ void EngineClock::startVariableFrame () {
 }
 
 EngineClock::Duration EngineClock::frameTime () const noexcept {
-    return ClockType::now() - m_prevFrameTime;
+    return now() - m_prevFrameTime;
 }
 
 double EngineClock::deltaTime () const noexcept {
@@ -41,3 +65,28 @@ double EngineClock::fixedDeltaTime () const noexcept {
 double EngineClock::variableDeltaTime () const noexcept {
     return std::chrono::duration_cast<std::chrono::duration<double>>(m_deltaTime).count();
 }
+
+EngineClock::TimePoint EngineClock::now () const noexcept {
+    return ClockType::now();
+}
+
+void EngineClock::sleepFor (Duration duration) const {
+    std::this_thread::sleep_for(duration);
+}
+
+void EngineClock::yield () const {
+    std::this_thread::yield();
+}
+
+void EngineClock::limitBacklog () {
+    // Called once the cap is hit with at least one more fixed timestep owed
+    // Dropping discards all of it, while slowing down keeps up to a frame's worth of timesteps to run in later frames
+    auto backlog = m_overflow == FixedStepOverflow::Drop ? m_fixedTimeSlop :
+                                                           m_fixedTimeSlop - m_fixedDeltaTime * m_maxFixedSteps;
+    if (backlog < m_fixedDeltaTime) {
+        return;
+    }
+
+    m_droppedSteps += static_cast<std::uint64_t>(backlog / m_fixedDeltaTime);
+    m_fixedTimeSlop -= (backlog / m_fixedDeltaTime) * m_fixedDeltaTime;
+}
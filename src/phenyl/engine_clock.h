@@ -1,35 +1,63 @@
 #pragma once
 
 #include "core/clock.h"
+#include "phenyl/properties.h"
 
 #include <chrono>
+#include <cstdint>
 
 namespace phenyl::engine {
 class EngineClock : public core::Clock {
 public:
     using Duration = std::chrono::nanoseconds;
+    using ClockType = std::chrono::steady_clock;
+    using TimePoint = ClockType::time_point;
 
     explicit EngineClock (Duration fixedDeltaTime);
+    ~EngineClock () override = default;
 
     void advance (double fixedTimeScale);
+    // Advances by exactly one fixed timestep regardless of how much real time has passed
+    void step (double fixedTimeScale);
+
+    // Caps the fixed timesteps run per frame, with 0 for no cap. Time beyond the cap is handled according to overflow
+    void setMaxFixedSteps (std::uint32_t maxSteps, FixedStepOverflow overflow);
 
     bool startFixedFrame ();
     void startVariableFrame ();
 
     Duration frameTime () const noexcept;
 
+    // Fixed timesteps skipped because of the per frame cap since the clock was created
+    [[nodiscard]] std::uint64_t droppedFixedSteps () const noexcept {
+        return m_droppedSteps;
+    }
+
     [[nodiscard]] double deltaTime () const noexcept override;
     [[nodiscard]] double fixedDeltaTime () const noexcept override;
     [[nodiscard]] double variableDeltaTime () const noexcept override;
 
-private:
-    using ClockType = std::chrono::steady_clock;
+    // Time source and waits used for frame pacing, which can be overridden to drive the clock with simulated time
+    [[nodiscard]] virtual TimePoint now () const noexcept;
+    virtual void sleepFor (Duration duration) const;
+    virtual void yield () const;
 
+protected:
+    EngineClock (Duration fixedDeltaTime, TimePoint startTime);
+
+private:
     Duration m_fixedDeltaTime;
 
-    ClockType::time_point m_prevFrameTime;
+    TimePoint m_prevFrameTime;
     Duration m_deltaTime{0};
     Duration m_fixedTimeSlop{0};
     bool isFixed = false;
+
+    std::uint32_t m_maxFixedSteps = 0;
+    FixedStepOverflow m_overflow = FixedStepOverflow::Drop;
+    std::uint32_t m_fixedSteps = 0;
+    std::uint64_t m_droppedSteps = 0;
+
+    void limitBacklog ();
 };
 } // namespace phenyl::engine
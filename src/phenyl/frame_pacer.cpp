@@ -0,0 +1,53 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+
+using namespace phenyl::engine;
+using namespace std::chrono_literals;
+
+// Bounds on how early sleeping stops. The lower bound keeps some yielding even if sleeps look exact, and the upper
+// bound stops one very late wakeup from turning most of the wait into yielding
+static constexpr EngineClock::Duration MIN_SLEEP_MARGIN = 100us;
+static constexpr EngineClock::Duration MAX_SLEEP_MARGIN = 4ms;
+static constexpr EngineClock::Duration START_SLEEP_MARGIN = 1ms;
+
+FramePacer::FramePacer (const EngineClock& clock) : m_clock{clock}, m_sleepMargin{START_SLEEP_MARGIN} {}
+
+FramePacer::Duration FramePacer::wait (Duration target) {
+    auto waited = false;
+    while (true) {
+        auto elapsed = m_clock.frameTime();
+        auto remaining = target - elapsed;
+        if (remaining <= Duration::zero()) {
+            break;
+        }
+
+        waited = true;
+        if (remaining > m_sleepMargin) {
+            auto requested = remaining - m_sleepMargin;
+            m_clock.sleepFor(requested);
+            onSleep(requested, m_clock.frameTime() - elapsed);
+        } else {
+            m_clock.yield();
+        }
+    }
+
+    m_lastError = m_clock.frameTime() - target;
+    if (waited) {
+        // Frames that were already over time are slow frames rather than pacing error
+        m_maxError = std::max(m_maxError, m_lastError);
+        m_totalError += m_lastError;
+        m_frames++;
+    } else {
+        m_overrunFrames++;
+    }
+
+    return m_lastError;
+}
+
+void FramePacer::onSleep (Duration requested, Duration slept) {
+    // Jumps up to the latest overshoot straight away but decays slowly, so the margin covers the worst recent wakeup
+    auto overshoot = std::max(slept - requested, Duration::zero());
+    m_overshoot = std::max(overshoot, m_overshoot - m_overshoot / 16);
+    m_sleepMargin = std::clamp(m_overshoot + m_overshoot / 2, MIN_SLEEP_MARGIN, MAX_SLEEP_MARGIN);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "engine_clock.h"
+
+#include <cstdint>
+
+namespace phenyl::engine {
+// Waits out the rest of each frame. Most of the wait is slept, with the last stretch spent yielding so the frame ends
+// close to the target even though sleeps overshoot. The stretch is sized from how far recent sleeps overshot
+class FramePacer {
+public:
+    using Duration = EngineClock::Duration;
+
+    explicit FramePacer (const EngineClock& clock);
+
+    // Waits until the frame has lasted target, returning how far past it the wait ended
+    Duration wait (Duration target);
+
+    // How far past the target the last frame ended
+    [[nodiscard]] Duration lastError () const noexcept {
+        return m_lastError;
+    }
+
+    // Worst and mean error over frames that finished early enough to need a wait
+    [[nodiscard]] Duration maxError () const noexcept {
+        return m_maxError;
+    }
+
+    [[nodiscard]] Duration meanError () const noexcept {
+        return m_frames ? m_totalError / static_cast<Duration::rep>(m_frames) : Duration::zero();
+    }
+
+    // Frames that had already run past the target before waiting
+    [[nodiscard]] std::uint64_t overrunFrames () const noexcept {
+        return m_overrunFrames;
+    }
+
+    // Time before the target at which sleeping stops
+    [[nodiscard]] Duration sleepMargin () const noexcept {
+        return m_sleepMargin;
+    }
+
+private:
+    const EngineClock& m_clock;
+
+    Duration m_sleepMargin;
+    Duration m_overshoot{0};
+
+    Duration m_lastError{0};
+    Duration m_maxError{0};
+    Duration m_totalError{0};
+    std::uint64_t m_frames = 0;
+    std::uint64_t m_overrunFrames = 0;
+
+    void onSleep (Duration requested, Duration slept);
+};
+} // namespace phenyl::engine
@@ -0,0 +1,63 @@
+#include "render_thread.h"
+
+#include "logging/logging.h"
+#include "util/trace.h"
+
+using namespace phenyl::engine;
+
+static phenyl::Logger LOGGER{"RENDER_THREAD", phenyl::PHENYL_LOGGER};
+
+RenderThread::RenderThread (graphics::Renderer& renderer) : m_renderer{renderer}, m_thread{&RenderThread::run, this} {
+    PHENYL_LOGI(LOGGER, "Started render thread");
+}
+
+RenderThread::~RenderThread () {
+    {
+        std::scoped_lock lock{m_mutex};
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    PHENYL_LOGI(LOGGER, "Stopped render thread");
+}
+
+void RenderThread::submit () {
+    {
+        std::scoped_lock lock{m_mutex};
+        PHENYL_DASSERT_MSG(!m_pending, "Submitted frame before previous frame was waited on");
+        m_pending = true;
+    }
+    m_cv.notify_all();
+}
+
+void RenderThread::wait () {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock lock{m_mutex};
+    m_cv.wait(lock, [&] { return !m_pending; });
+    m_waitTime += std::chrono::steady_clock::now() - start;
+}
+
+void RenderThread::run () {
+    std::unique_lock lock{m_mutex};
+    while (true) {
+        // Frames already submitted are finished before stopping
+        m_cv.wait(lock, [&] { return m_pending || m_stop; });
+        if (!m_pending) {
+            break;
+        }
+
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        {
+            util::TraceZone zone{"graphics", "Renderer::render"};
+            auto resourceLock = m_renderer.lockResources();
+            m_renderer.render();
+        }
+        auto renderTime = std::chrono::steady_clock::now() - start;
+        lock.lock();
+
+        m_renderTime += renderTime;
+        m_pending = false;
+        m_cv.notify_all();
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "graphics/backend/renderer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace phenyl::engine {
+// Renders frames on a dedicated thread so the next frame can be simulated while the last one is recorded and
+// submitted. The render layers hold the frame handed over by the Render stage, so the thread must be waited on before
+// the Render stage runs again
+class RenderThread {
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    explicit RenderThread (graphics::Renderer& renderer);
+    ~RenderThread ();
+
+    RenderThread (const RenderThread&) = delete;
+    RenderThread& operator= (const RenderThread&) = delete;
+
+    // Starts rendering the frame in the render layers. The previous frame must have been waited on
+    void submit ();
+    // Blocks until the submitted frame has finished rendering
+    void wait ();
+
+    // Time the simulation spent blocked in wait(), which is time rendering didn't overlap with simulating
+    [[nodiscard]] Duration waitTime () const noexcept {
+        return m_waitTime;
+    }
+
+    // Time spent rendering on the render thread
+    [[nodiscard]] Duration renderTime () const noexcept {
+        return m_renderTime;
+    }
+
+private:
+    graphics::Renderer& m_renderer;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_pending = false;
+    bool m_stop = false;
+
+    Duration m_waitTime{0};
+    Duration m_renderTime{0};
+
+    // Started last so everything it uses is set up first
+    std::thread m_thread;
+
+    void run ();
+};
+} // namespace phenyl::engine